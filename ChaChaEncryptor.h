@@ -1,21 +1,53 @@
 #pragma once
 // file ChaChaEncryptor.h
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <cstring>
 #include <bit>
+#include <string_view>
+
+#include "cpu_features.h"
+
+// #define ChaChaEnableSIMD 1
+// Set to 1 to generate keystream for bulk crypt() calls 4, 8 or 16 blocks at
+// a time with SSE2, AVX2 or AVX-512 (chosen at runtime with cpuid).
+// Set to 0 to always use the one-block scalar refill.
+#define ChaChaEnableSIMD 1
+
+#if CPU_FEATURES_X86
+#   include <immintrin.h>
+#   if defined(_MSC_VER)
+#       define CHACHA_TARGET(features)
+#   else
+#       define CHACHA_TARGET(features) __attribute__((target(features)))
+#   endif
+#endif
 
 namespace ChaCha {
 
     using ChaChaKey = std::array<uint32_t, 8>;   // 256-bit
     using ChaChaNonce = std::array<uint32_t, 3>;   // 96-bit
 
+    // Zeroes n bytes through volatile pointers, so the stores to key
+    // material or keystream that is about to go out of scope are kept.
+    // Aligned words are cleared 8 bytes at a time.
+    inline void wipe(void* p, size_t n) noexcept {
+        volatile uint8_t* q = static_cast<volatile uint8_t*>(p);
+        for (; n > 0 && reinterpret_cast<uintptr_t>(q) % 8 != 0; --n) *q++ = 0;
+        volatile uint64_t* w = reinterpret_cast<volatile uint64_t*>(q);
+        for (; n >= 8; n -= 8) *w++ = 0;
+        q = reinterpret_cast<volatile uint8_t*>(w);
+        for (; n > 0; --n) *q++ = 0;
+    }
+
     class ChaCha20 {
         alignas(64) uint32_t state[16]{};     // full state (cache-line aligned!)
         alignas(64) uint32_t keystream[16]{};
         size_t keystream_pos = 64;            // force first generation
         uint64_t block_counter;
+        uint64_t initial_block;               // block at stream offset 0 (for seek)
 
         static constexpr uint32_t sigma[4] = {
             0x61707865, 0x3320646e, 0x79622d32, 0x6b206574
@@ -25,6 +57,7 @@ namespace ChaCha {
         ChaCha20(const ChaChaKey& key, const ChaChaNonce& nonce, uint64_t initial_counter = 1)
         {
             block_counter = initial_counter;
+            initial_block = initial_counter;
 
             std::memcpy(state, sigma, 16);
             std::memcpy(state + 4, key.data(), 32);
@@ -45,6 +78,59 @@ namespace ChaCha {
             xor_stream(data, data, len);
         }
 
+        // Encrypt/decrypt from in to out (same length; in == out is allowed)
+        void crypt(uint8_t* out, const uint8_t* in, size_t len) noexcept {
+            xor_stream(out, in, len);
+        }
+
+        // Byte offset of the next keystream byte, from the initial counter.
+        uint64_t tell() const noexcept {
+            return (block_counter - initial_block) * 64 - (64 - keystream_pos);
+        }
+
+        // Random access: the next crypt() continues at byte_offset of the stream.
+        void seek(uint64_t byte_offset) noexcept {
+            set_counter(initial_block + byte_offset / 64);
+            keystream_pos = 64;
+            if (byte_offset % 64 != 0) {
+                refill_keystream();                 // block of byte_offset; counter moves past it
+                keystream_pos = size_t(byte_offset % 64);
+            }
+        }
+
+        /*----------------------------------------------------------------*
+         *  crypt_parallel – same output and end position as crypt()
+         *
+         *  The bytes up to the next 64-byte boundary are done here; the
+         *  rest is cut into ParallelChunk pieces, each crypted by a copy
+         *  of this object seek()'d to its offset. Pool is ThreadPool
+         *  (ThreadPool.h) or anything with parallel_for(n, fn(size_t)).
+         *----------------------------------------------------------------*/
+        static constexpr size_t ParallelChunk = size_t(1) << 20;   // multiple of 64
+
+        template <typename Pool>
+        void crypt_parallel(uint8_t* data, size_t len, Pool& pool) {
+            const uint64_t start = tell();
+            const size_t head = std::min<size_t>(len, size_t((64 - start % 64) % 64));
+            xor_stream(data, data, head);
+            data += head;
+            len -= head;
+            if (len < 2 * ParallelChunk) {
+                xor_stream(data, data, len);
+                return;
+            }
+
+            const uint64_t base = start + head;
+            const size_t pieces = (len + ParallelChunk - 1) / ParallelChunk;
+            pool.parallel_for(pieces, [&](size_t i) {
+                const size_t off = i * ParallelChunk;
+                ChaCha20 piece(*this);
+                piece.seek(base + off);
+                piece.xor_stream(data + off, data + off, std::min(ParallelChunk, len - off));
+            });
+            seek(base + len);
+        }
+
         // one-shot API for 64 byte encrytion
         std::array<uint64_t, 8> encrypt_block(const std::array<uint64_t, 8>& block) noexcept {
             std::array<uint64_t, 8> result(block);
@@ -52,7 +138,25 @@ namespace ChaCha {
             return result;
         }
 
+        // Name of the bulk keystream kernel on this machine: "avx512", "avx2", "sse2" or "scalar".
+        static const char* kernel_name() noexcept {
+            return wide_kernel().name;
+        }
+
+        // crypt(out, in, len) with the named kernel instead of kernel_name()'s,
+        // for tests and benchmarks. Returns false, and does nothing, if this
+        // build or CPU does not have it. "scalar" is always there.
+        bool crypt_with(std::string_view kernel, uint8_t* out, const uint8_t* in, size_t len) noexcept {
+            const WideKernel wide = wide_kernel_named(kernel);
+            if (wide.name == nullptr)
+                return false;
+            xor_stream(wide, out, in, len);
+            return true;
+        }
+
     private:
+        struct WideKernel;                    // the wide keystream kernels, below
+
         // Refill keystream when exhausted
         void refill_keystream() noexcept {
             uint32_t input[16];
@@ -75,24 +179,40 @@ namespace ChaCha {
                 keystream[i] = input[i] + state[i];
 
             // Increment counter (64-bit!)
-            ++block_counter;
-            state[12] = uint32_t(block_counter);
-            state[13] = uint32_t(block_counter >> 32);
+            set_counter(block_counter + 1);
 
             keystream_pos = 0;
         }
 
         // XOR arbitrary data with ChaCha20 stream
         void xor_stream(uint8_t* out, const uint8_t* in, size_t len) noexcept {
+            xor_stream(wide_kernel(), out, in, len);
+        }
+
+        void xor_stream(const WideKernel& wide, uint8_t* out, const uint8_t* in, size_t len) noexcept {
             while (len > 0) {
-                if (keystream_pos >= 64)
+                if (keystream_pos >= 64) {
+                    // On a block boundary with enough data left: run the wide kernel.
+                    const size_t run = wide.blocks * 64;
+                    if (wide.fn && len >= run) {
+                        alignas(64) uint8_t ks[16 * 64];
+                        do {
+                            wide.fn(state, block_counter, ks);
+                            xor_words(out, in, ks, run);
+                            set_counter(block_counter + wide.blocks);
+                            out += run;
+                            in += run;
+                            len -= run;
+                        } while (len >= run);
+                        wipe(ks, run);
+                        continue;
+                    }
                     refill_keystream();
+                }
 
                 size_t take = std::min(len, 64 - keystream_pos);
                 const uint8_t* ks = reinterpret_cast<const uint8_t*>(keystream) + keystream_pos;
-
-                for (size_t i = 0; i < take; ++i)
-                    out[i] = in[i] ^ ks[i];
+                xor_words(out, in, ks, take);
 
                 out += take;
                 in += take;
@@ -101,6 +221,226 @@ namespace ChaCha {
             }
         }
 
+        // out = in ^ ks, eight bytes at a time (the compiler widens this further).
+        static inline void xor_words(uint8_t* out, const uint8_t* in, const uint8_t* ks, size_t n) noexcept {
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                uint64_t a, b;
+                std::memcpy(&a, in + i, 8);
+                std::memcpy(&b, ks + i, 8);
+                a ^= b;
+                std::memcpy(out + i, &a, 8);
+            }
+            for (; i < n; ++i)
+                out[i] = in[i] ^ ks[i];
+        }
+
+        void set_counter(uint64_t counter) noexcept {
+            block_counter = counter;
+            state[12] = uint32_t(block_counter);
+            state[13] = uint32_t(block_counter >> 32);
+        }
+
+        /*----------------------------------------------------------------*
+         *  Wide keystream kernels
+         *
+         *  fn(state, counter, out) writes the keystream blocks for
+         *  counter, counter+1, ..., counter+blocks-1 to out (blocks * 64
+         *  bytes), exactly as that many refill_keystream() calls would.
+         *  Vector register i holds state word i of every block; after the
+         *  rounds the words are transposed back into per-block order.
+         *----------------------------------------------------------------*/
+        using wide_fn = void (*)(const uint32_t* state, uint64_t counter, uint8_t* out) noexcept;
+        struct WideKernel { wide_fn fn; size_t blocks; const char* name; };
+
+        static const WideKernel& wide_kernel() noexcept {
+            static const WideKernel kernel = select_wide_kernel();
+            return kernel;
+        }
+
+        // The named kernel if this build and CPU have it, else { nullptr, 0, nullptr }.
+        static WideKernel wide_kernel_named(std::string_view name) noexcept {
+            if (name == "scalar")
+                return { nullptr, 1, "scalar" };
+#if CPU_FEATURES_X86
+            const cpu_features::Features& cpu = cpu_features::get();
+            if (name == "avx512" && cpu.avx512f)
+                return { &keystream16_avx512, 16, "avx512" };
+            if (name == "avx2" && cpu.avx2)
+                return { &keystream8_avx2, 8, "avx2" };
+            if (name == "sse2" && cpu.sse2)
+                return { &keystream4_sse2, 4, "sse2" };
+#endif
+            return { nullptr, 0, nullptr };
+        }
+
+        static WideKernel select_wide_kernel() noexcept {
+#if ChaChaEnableSIMD
+            for (const char* name : { "avx512", "avx2", "sse2" }) {
+                const WideKernel kernel = wide_kernel_named(name);
+                if (kernel.name != nullptr)
+                    return kernel;
+            }
+#endif
+            return wide_kernel_named("scalar");
+        }
+
+        // Per-block counter words: lo[j], hi[j] for block counter + j.
+        static inline void lane_counters(uint64_t counter, size_t blocks, uint32_t* lo, uint32_t* hi) noexcept {
+            for (size_t j = 0; j < blocks; ++j) {
+                lo[j] = uint32_t(counter + j);
+                hi[j] = uint32_t((counter + j) >> 32);
+            }
+        }
+
+#if CPU_FEATURES_X86
+        // Twenty rounds over vectors x[16]; CHACHA_ADD, CHACHA_XOR and CHACHA_ROTL
+        // are the ISA's lane operations, defined by each kernel below.
+#define CHACHA_VQR(a, b, c, d)                                                                  \
+        x[a] = CHACHA_ADD(x[a], x[b]); x[d] = CHACHA_ROTL(CHACHA_XOR(x[d], x[a]), 16);          \
+        x[c] = CHACHA_ADD(x[c], x[d]); x[b] = CHACHA_ROTL(CHACHA_XOR(x[b], x[c]), 12);          \
+        x[a] = CHACHA_ADD(x[a], x[b]); x[d] = CHACHA_ROTL(CHACHA_XOR(x[d], x[a]), 8);           \
+        x[c] = CHACHA_ADD(x[c], x[d]); x[b] = CHACHA_ROTL(CHACHA_XOR(x[b], x[c]), 7);
+#define CHACHA_VROUNDS                                                 \
+        for (int r = 0; r < 10; ++r) {                                 \
+            CHACHA_VQR(0, 4, 8, 12) CHACHA_VQR(1, 5, 9, 13)            \
+            CHACHA_VQR(2, 6, 10, 14) CHACHA_VQR(3, 7, 11, 15)          \
+            CHACHA_VQR(0, 5, 10, 15) CHACHA_VQR(1, 6, 11, 12)          \
+            CHACHA_VQR(2, 7, 8, 13) CHACHA_VQR(3, 4, 9, 14)            \
+        }
+
+        // 4x4 transpose of 32-bit words: r[j] = (w0[j], w1[j], w2[j], w3[j]), per 128-bit lane.
+#define CHACHA_TRANSPOSE4(T, UNPACKLO32, UNPACKHI32, UNPACKLO64, UNPACKHI64, w0, w1, w2, w3, r) \
+        {                                                              \
+            const T t0 = UNPACKLO32(w0, w1), t1 = UNPACKLO32(w2, w3);  \
+            const T t2 = UNPACKHI32(w0, w1), t3 = UNPACKHI32(w2, w3);  \
+            r[0] = UNPACKLO64(t0, t1); r[1] = UNPACKHI64(t0, t1);      \
+            r[2] = UNPACKLO64(t2, t3); r[3] = UNPACKHI64(t2, t3);      \
+        }
+
+        CHACHA_TARGET("sse2")
+        static void keystream4_sse2(const uint32_t* state, uint64_t counter, uint8_t* out) noexcept {
+#define CHACHA_ADD(a, b) _mm_add_epi32(a, b)
+#define CHACHA_XOR(a, b) _mm_xor_si128(a, b)
+#define CHACHA_ROTL(v, n) _mm_or_si128(_mm_slli_epi32(v, n), _mm_srli_epi32(v, 32 - (n)))
+            alignas(16) uint32_t lo[4], hi[4];
+            lane_counters(counter, 4, lo, hi);
+
+            __m128i in[16], x[16];
+            for (int i = 0; i < 16; ++i) in[i] = _mm_set1_epi32((int)state[i]);
+            in[12] = _mm_load_si128(reinterpret_cast<const __m128i*>(lo));
+            in[13] = _mm_load_si128(reinterpret_cast<const __m128i*>(hi));
+            for (int i = 0; i < 16; ++i) x[i] = in[i];
+
+            CHACHA_VROUNDS
+            for (int i = 0; i < 16; ++i) x[i] = CHACHA_ADD(x[i], in[i]);
+
+            for (int g = 0; g < 4; ++g) {
+                __m128i r[4];
+                CHACHA_TRANSPOSE4(__m128i, _mm_unpacklo_epi32, _mm_unpackhi_epi32,
+                    _mm_unpacklo_epi64, _mm_unpackhi_epi64,
+                    x[4 * g], x[4 * g + 1], x[4 * g + 2], x[4 * g + 3], r)
+                for (int j = 0; j < 4; ++j)
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 64 * j + 16 * g), r[j]);
+            }
+#undef CHACHA_ADD
+#undef CHACHA_XOR
+#undef CHACHA_ROTL
+        }
+
+        CHACHA_TARGET("avx2")
+        static void keystream8_avx2(const uint32_t* state, uint64_t counter, uint8_t* out) noexcept {
+            // Rotations by 16 and 8 are byte shuffles.
+            const __m256i R16 = _mm256_setr_epi8(
+                2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+            const __m256i R8 = _mm256_setr_epi8(
+                3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+                3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+#define CHACHA_ADD(a, b) _mm256_add_epi32(a, b)
+#define CHACHA_XOR(a, b) _mm256_xor_si256(a, b)
+#define CHACHA_ROTL(v, n) ((n) == 16 ? _mm256_shuffle_epi8(v, R16) : (n) == 8 ? _mm256_shuffle_epi8(v, R8) \
+                           : _mm256_or_si256(_mm256_slli_epi32(v, n), _mm256_srli_epi32(v, 32 - (n))))
+            alignas(32) uint32_t lo[8], hi[8];
+            lane_counters(counter, 8, lo, hi);
+
+            __m256i in[16], x[16];
+            for (int i = 0; i < 16; ++i) in[i] = _mm256_set1_epi32((int)state[i]);
+            in[12] = _mm256_load_si256(reinterpret_cast<const __m256i*>(lo));
+            in[13] = _mm256_load_si256(reinterpret_cast<const __m256i*>(hi));
+            for (int i = 0; i < 16; ++i) x[i] = in[i];
+
+            CHACHA_VROUNDS
+            for (int i = 0; i < 16; ++i) x[i] = CHACHA_ADD(x[i], in[i]);
+
+            // After the in-lane transpose, r[j] holds block j (low half) and block j+4 (high half).
+            for (int g = 0; g < 4; ++g) {
+                __m256i r[4];
+                CHACHA_TRANSPOSE4(__m256i, _mm256_unpacklo_epi32, _mm256_unpackhi_epi32,
+                    _mm256_unpacklo_epi64, _mm256_unpackhi_epi64,
+                    x[4 * g], x[4 * g + 1], x[4 * g + 2], x[4 * g + 3], r)
+                for (int j = 0; j < 4; ++j) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 64 * j + 16 * g),
+                        _mm256_castsi256_si128(r[j]));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 64 * (j + 4) + 16 * g),
+                        _mm256_extracti128_si256(r[j], 1));
+                }
+            }
+#undef CHACHA_ADD
+#undef CHACHA_XOR
+#undef CHACHA_ROTL
+        }
+
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Wuninitialized"    // GCC 12 avx512fintrin.h (_mm512_undefined_*)
+#endif
+        CHACHA_TARGET("avx512f")
+        static void keystream16_avx512(const uint32_t* state, uint64_t counter, uint8_t* out) noexcept {
+#define CHACHA_ADD(a, b) _mm512_add_epi32(a, b)
+#define CHACHA_XOR(a, b) _mm512_xor_si512(a, b)
+#define CHACHA_ROTL(v, n) _mm512_rol_epi32(v, n)
+            alignas(64) uint32_t lo[16], hi[16];
+            lane_counters(counter, 16, lo, hi);
+
+            __m512i in[16], x[16];
+            for (int i = 0; i < 16; ++i) in[i] = _mm512_set1_epi32((int)state[i]);
+            in[12] = _mm512_load_si512(lo);
+            in[13] = _mm512_load_si512(hi);
+            for (int i = 0; i < 16; ++i) x[i] = in[i];
+
+            CHACHA_VROUNDS
+            for (int i = 0; i < 16; ++i) x[i] = CHACHA_ADD(x[i], in[i]);
+
+            // After the in-lane transpose, 128-bit lane k of r[j] holds block j + 4k.
+            for (int g = 0; g < 4; ++g) {
+                __m512i r[4];
+                CHACHA_TRANSPOSE4(__m512i, _mm512_unpacklo_epi32, _mm512_unpackhi_epi32,
+                    _mm512_unpacklo_epi64, _mm512_unpackhi_epi64,
+                    x[4 * g], x[4 * g + 1], x[4 * g + 2], x[4 * g + 3], r)
+                for (int j = 0; j < 4; ++j) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 64 * j + 16 * g),
+                        _mm512_extracti32x4_epi32(r[j], 0));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 64 * (j + 4) + 16 * g),
+                        _mm512_extracti32x4_epi32(r[j], 1));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 64 * (j + 8) + 16 * g),
+                        _mm512_extracti32x4_epi32(r[j], 2));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 64 * (j + 12) + 16 * g),
+                        _mm512_extracti32x4_epi32(r[j], 3));
+                }
+            }
+#undef CHACHA_ADD
+#undef CHACHA_XOR
+#undef CHACHA_ROTL
+        }
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC diagnostic pop
+#endif
+#undef CHACHA_VQR
+#undef CHACHA_VROUNDS
+#undef CHACHA_TRANSPOSE4
+#endif
+
         static inline void QR(uint32_t& a, uint32_t& b, uint32_t& c, uint32_t& d) noexcept {
             a += b; d ^= a; d = std::rotl(d, 16);
             c += d; b ^= c; b = std::rotl(b, 12);
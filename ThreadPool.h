@@ -0,0 +1,118 @@
+#pragma once
+// file ThreadPool.h
+// MIT License. Copyright (c) 2025 Jim Staley. See LICENSE for details.
+
+/*
+file ThreadPool.h
+
+A small fixed-size thread pool, shared by the parallel drivers
+(jsHashTree.h, ...).
+
+    ThreadPool pool;                        // one worker per hardware thread
+    pool.parallel_for(n, [&](size_t i) { work(i); });
+    auto f = pool.submit([] { return 42; });
+
+parallel_for() hands out indices one at a time from an atomic counter,
+so uneven work items balance themselves. The calling thread takes part
+in the loop.
+Work items must not throw, and parallel_for() must not be called from
+inside a pool task.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class ThreadPool {
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stopping = false;
+
+public:
+    // nthreads == 0 → one worker per hardware thread.
+    explicit ThreadPool(unsigned nthreads = 0) {
+        if (nthreads == 0)
+            nthreads = std::max(1u, std::thread::hardware_concurrency());
+        workers.reserve(nthreads);
+        for (unsigned i = 0; i < nthreads; ++i)
+            workers.emplace_back([this] { worker_loop(); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto& t : workers)
+            t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const noexcept { return (unsigned)workers.size(); }
+
+    // Queue one task; the future carries its result.
+    template <typename F>
+    auto submit(F&& f) -> std::future<std::invoke_result_t<F>> {
+        using R = std::invoke_result_t<F>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        std::future<R> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            tasks.emplace([task] { (*task)(); });
+        }
+        cv.notify_one();
+        return result;
+    }
+
+    // Runs fn(i) for every i in [0, n) and returns when all are done.
+    template <typename F>
+    void parallel_for(size_t n, F&& fn) {
+        if (n == 0) return;
+
+        std::atomic<size_t> next{ 0 };
+        auto run = [&] {
+            for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < n; )
+                fn(i);
+        };
+
+        const size_t helpers = std::min<size_t>(workers.size(), n - 1);
+        std::vector<std::future<void>> done;
+        done.reserve(helpers);
+        for (size_t h = 0; h < helpers; ++h)
+            done.push_back(submit(run));
+
+        run();  // the caller works too
+        for (auto& f : done)
+            f.wait();
+    }
+
+private:
+    void worker_loop() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty())
+                    return;
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+};
@@ -0,0 +1,453 @@
+// file bench_jsHash.cpp
+// MIT License. Copyright (c) 2025 Jim Staley. See LICENSE for details.
+//
+// Benchmark suite for jsHash and ChaCha20.
+//
+//     bench_jsHash [--core N] [--min-size B] [--max-size B] [--ops a,b,...]
+//                  [--json FILE] [--quick]
+//
+// For every operation and input size (powers of 4 from 1 B to 1 GiB by
+// default) it measures aligned and unaligned (+1 byte) input, with warm
+// and cold caches, and reports ns/op, GB/s and cycles/byte. Cycles come
+// from perf_event_open (core cycles) when the kernel allows it, otherwise
+// from the TSC (reference cycles); the source is printed and recorded.
+// --json writes every measurement for regression tracking.
+//
+// Operations
+//     hash64      Hash64() one-shot
+//     hash128     jsHash + insert() + hash128()
+//     hash256     jsHash + insert() + hash256()
+//     wide8       jsHashT<8>::hash64_oneshot() (different values, 8 lanes)
+//     wide16      jsHashT<16>::hash64_oneshot() (16 lanes)
+//     secure256   jsHash + insert() + hash_secure<4>()
+//     securefin   jsHash + insert() + SecureFinalizer::finalize<4>()
+//     chacha      ChaCha20::crypt() in place
+//     latency     chained Hash64 (each result seeds the next), 0..64 B
+//     map         jsHashMap::FlatMap vs std::unordered_map with a Hash64
+//                 hasher: insert, successful and failed find of string keys;
+//                 "bytes" is the key count, GB/s and cyc/B count key bytes
+//
+// Build: g++ -O2 -std=c++20 -pthread bench_jsHash.cpp -o bench_jsHash
+
+#include "jsHash.h"
+#include "jsHashMap.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__)
+#   include <linux/perf_event.h>
+#   include <pthread.h>
+#   include <sched.h>
+#   include <sys/ioctl.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#endif
+#if defined(_MSC_VER)
+#   include <intrin.h>      // __rdtsc
+#elif defined(__x86_64__) || defined(__i386__)
+#   include <x86intrin.h>   // __rdtsc
+#endif
+
+namespace {
+
+    /*----------------------------------------------------------------*
+     *  Platform helpers
+     *----------------------------------------------------------------*/
+    bool pin_to_core(int core) {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)core;
+        return false;
+#endif
+    }
+
+    // Core cycles from perf_event_open; TSC ticks when that is not allowed.
+    class CycleCounter {
+#if defined(__linux__)
+        int fd = -1;
+#endif
+        uint64_t start_value = 0;
+
+    public:
+        CycleCounter() {
+#if defined(__linux__)
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+        }
+        ~CycleCounter() {
+#if defined(__linux__)
+            if (fd >= 0) close(fd);
+#endif
+        }
+
+        const char* source() const {
+#if defined(__linux__)
+            if (fd >= 0) return "perf";
+#endif
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+            return "tsc";
+#else
+            return "none";
+#endif
+        }
+
+        void start() { start_value = read(); }
+        uint64_t stop() { return read() - start_value; }
+
+    private:
+        uint64_t read() const {
+#if defined(__linux__)
+            if (fd >= 0) {
+                uint64_t count = 0;
+                if (::read(fd, &count, sizeof(count)) == (ssize_t)sizeof(count))
+                    return count;
+            }
+#endif
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#else
+            return 0;
+#endif
+        }
+    };
+
+    volatile uint64_t sink;     // keeps results alive
+
+    /*----------------------------------------------------------------*
+     *  Measurement
+     *----------------------------------------------------------------*/
+    struct Result {
+        std::string op;
+        size_t size;
+        bool aligned;
+        bool cold;
+        size_t iters;
+        double ns_per_op;
+        double gb_per_s;
+        double cycles_per_byte;
+    };
+
+    using OpFn = void (*)(uint8_t* p, size_t n);
+
+    const ChaCha::ChaChaKey bench_key{ 1, 2, 3, 4, 5, 6, 7, 8 };
+    const ChaCha::ChaChaNonce bench_nonce{ 9, 10, 11 };
+
+    void op_hash64(uint8_t* p, size_t n) { sink = sink + Hash64(p, n, 42); }
+    void op_hash128(uint8_t* p, size_t n) {
+        jsHash h(42); h.insert(p, n); sink = sink + h.hash128()[0];
+    }
+    void op_hash256(uint8_t* p, size_t n) {
+        jsHash h(42); h.insert(p, n); sink = sink + h.hash256()[0];
+    }
+    void op_wide8(uint8_t* p, size_t n) { sink = sink + jsHashT<8>::hash64_oneshot(p, n, 42); }
+    void op_wide16(uint8_t* p, size_t n) { sink = sink + jsHashT<16>::hash64_oneshot(p, n, 42); }
+    void op_secure256(uint8_t* p, size_t n) {
+        jsHash h(42); h.insert(p, n); sink = sink + h.hash_secure<4>(bench_key, bench_nonce)[0];
+    }
+    void op_securefin(uint8_t* p, size_t n) {
+        static const jsHash::SecureFinalizer fin(bench_key, bench_nonce);
+        jsHash h(42); h.insert(p, n); sink = sink + fin.finalize<4>(h)[0];
+    }
+    void op_chacha(uint8_t* p, size_t n) {
+        ChaCha::ChaCha20 c(bench_key, bench_nonce);
+        c.crypt(p, n);
+        sink = sink + p[0];
+    }
+
+    struct Op { const char* name; OpFn fn; };
+    const Op all_ops[] = {
+        { "hash64", op_hash64 }, { "hash128", op_hash128 }, { "hash256", op_hash256 },
+        { "wide8", op_wide8 }, { "wide16", op_wide16 },
+        { "secure256", op_secure256 }, { "securefin", op_securefin }, { "chacha", op_chacha },
+    };
+
+    // Touching a buffer larger than the last-level cache evicts the input.
+    void evict(std::vector<uint8_t>& scratch) {
+        for (size_t i = 0; i < scratch.size(); i += 64)
+            scratch[i]++;
+        sink = sink + scratch[0];
+    }
+
+    Result measure(const Op& op, uint8_t* p, size_t n, bool aligned, bool cold,
+        double target_seconds, std::vector<uint8_t>& scratch, CycleCounter& cycles)
+    {
+        using clock = std::chrono::steady_clock;
+
+        // Warm-up, and a first guess at the time per call.
+        auto t0 = clock::now();
+        op.fn(p, n);
+        double guess = std::chrono::duration<double>(clock::now() - t0).count();
+        size_t iters = (size_t)std::clamp(target_seconds / std::max(guess, 1e-9), 3.0, 5e7);
+        if (cold)
+            iters = std::min<size_t>(iters, 200);   // each cold call pays for an eviction pass
+
+        double seconds = 0;
+        uint64_t cyc = 0;
+        if (cold) {
+            for (size_t i = 0; i < iters; ++i) {
+                evict(scratch);
+                cycles.start();
+                auto a = clock::now();
+                op.fn(p, n);
+                auto b = clock::now();
+                cyc += cycles.stop();
+                seconds += std::chrono::duration<double>(b - a).count();
+            }
+        }
+        else {
+            cycles.start();
+            auto a = clock::now();
+            for (size_t i = 0; i < iters; ++i)
+                op.fn(p, n);
+            auto b = clock::now();
+            cyc = cycles.stop();
+            seconds = std::chrono::duration<double>(b - a).count();
+        }
+
+        const double bytes = (double)n * iters;
+        return { op.name, n, aligned, cold, iters,
+            seconds * 1e9 / iters,
+            n ? bytes / seconds / 1e9 : 0.0,
+            n ? cyc / bytes : 0.0 };
+    }
+
+    // Chained one-shot Hash64: each result is the next seed, so calls cannot overlap.
+    std::vector<Result> measure_latency(CycleCounter& cycles) {
+        using clock = std::chrono::steady_clock;
+        constexpr size_t ITERS = 2'000'000;
+        alignas(64) uint8_t data[64];
+        std::mt19937_64 mt(54321);
+        for (auto& b : data) b = uint8_t(mt());
+
+        std::vector<Result> results;
+        for (size_t len : { 0, 4, 8, 16, 24, 32, 40, 48, 64 }) {
+            uint64_t seed = 42;
+            cycles.start();
+            auto a = clock::now();
+            for (size_t i = 0; i < ITERS; ++i)
+                seed = Hash64(data, len, seed);
+            auto b = clock::now();
+            const uint64_t cyc = cycles.stop();
+            sink = sink + seed;
+            const double seconds = std::chrono::duration<double>(b - a).count();
+            results.push_back({ "latency", len, true, false, ITERS,
+                seconds * 1e9 / ITERS,
+                len ? (double)len * ITERS / seconds / 1e9 : 0.0,
+                len ? (double)cyc / ((double)len * ITERS) : 0.0 });
+        }
+        return results;
+    }
+
+    // Hash map insert / hit / miss for n string keys, per key.
+    struct Hash64String {
+        size_t operator()(const std::string& s) const noexcept { return Hash64(s.data(), s.size(), 42); }
+    };
+
+    template <typename Map>
+    void measure_map(const char* prefix, const std::vector<std::string>& keys,
+        const std::vector<std::string>& absent, CycleCounter& cycles, std::vector<Result>& results)
+    {
+        using clock = std::chrono::steady_clock;
+        size_t key_bytes = 0;
+        for (const std::string& k : keys) key_bytes += k.size();
+
+        const auto record = [&](const char* what, auto&& body) {
+            cycles.start();
+            auto a = clock::now();
+            body();
+            auto b = clock::now();
+            const uint64_t cyc = cycles.stop();
+            const double seconds = std::chrono::duration<double>(b - a).count();
+            results.push_back({ std::string(prefix) + what, keys.size(), true, false, keys.size(),
+                seconds * 1e9 / keys.size(), key_bytes / seconds / 1e9, (double)cyc / key_bytes });
+        };
+
+        Map m;
+        record("_ins", [&] {
+            for (size_t i = 0; i < keys.size(); ++i) m.try_emplace(keys[i], i);
+        });
+        record("_hit", [&] {
+            size_t sum = 0;
+            for (const std::string& k : keys) sum += m.find(k)->second;
+            sink = sink + sum;
+        });
+        record("_miss", [&] {
+            size_t found = 0;
+            for (const std::string& k : absent) found += (m.find(k) != m.end());
+            sink = sink + found;
+        });
+    }
+
+    std::vector<Result> measure_maps(CycleCounter& cycles) {
+        std::vector<Result> results;
+        std::mt19937_64 mt(777);
+        for (size_t n : { size_t(1) << 10, size_t(1) << 16, size_t(1) << 20 }) {
+            std::vector<std::string> keys, absent;
+            for (size_t i = 0; i < n; ++i) {
+                keys.push_back("key:" + std::to_string(mt()));
+                absent.push_back("nokey:" + std::to_string(mt()));
+            }
+            std::shuffle(absent.begin(), absent.end(), mt);
+            measure_map<jsHashMap::FlatMap<std::string, size_t>>("flat", keys, absent, cycles, results);
+            measure_map<std::unordered_map<std::string, size_t, Hash64String>>("std", keys, absent, cycles, results);
+        }
+        return results;
+    }
+
+    void print(const Result& r) {
+        std::cout << std::left << std::setw(10) << r.op << std::right
+            << std::setw(12) << r.size
+            << std::setw(10) << (r.aligned ? "aligned" : "+1")
+            << std::setw(6) << (r.cold ? "cold" : "warm")
+            << std::fixed << std::setprecision(2)
+            << std::setw(14) << r.ns_per_op
+            << std::setw(10) << r.gb_per_s
+            << std::setw(10) << r.cycles_per_byte << "\n";
+    }
+
+    void write_json(const std::string& path, const std::vector<Result>& results,
+        const char* cycle_source, int core)
+    {
+        std::ofstream out(path);
+        out << "{\n";
+        out << "  \"column_kernel\": \"" << jsHash::column_kernel_name() << "\",\n";
+        out << "  \"chacha_kernel\": \"" << ChaCha::ChaCha20::kernel_name() << "\",\n";
+        out << "  \"cycles_source\": \"" << cycle_source << "\",\n";
+        out << "  \"core\": " << core << ",\n";
+        out << "  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            std::ostringstream line;
+            line << std::setprecision(6)
+                << "    {\"op\": \"" << r.op << "\", \"size\": " << r.size
+                << ", \"aligned\": " << (r.aligned ? "true" : "false")
+                << ", \"cache\": \"" << (r.cold ? "cold" : "warm") << "\""
+                << ", \"iters\": " << r.iters
+                << ", \"ns_per_op\": " << r.ns_per_op
+                << ", \"gb_per_s\": " << r.gb_per_s
+                << ", \"cycles_per_byte\": " << r.cycles_per_byte << "}";
+            out << line.str() << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+    }
+
+    int usage() {
+        std::cerr <<
+            "usage: bench_jsHash [--core N] [--min-size B] [--max-size B] [--ops a,b,...]\n"
+            "                    [--json FILE] [--quick]\n"
+            "ops: hash64 hash128 hash256 wide8 wide16 secure256 securefin chacha latency map\n";
+        return 2;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int core = 0;
+    size_t min_size = 1;
+    size_t max_size = size_t(1) << 30;
+    double target_seconds = 0.05;
+    std::string ops = "hash64,hash128,hash256,wide8,wide16,secure256,securefin,chacha,latency,map";
+    std::string json_path;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--core" && has_value)          core = std::atoi(argv[++i]);
+        else if (arg == "--min-size" && has_value) min_size = std::strtoull(argv[++i], nullptr, 0);
+        else if (arg == "--max-size" && has_value) max_size = std::strtoull(argv[++i], nullptr, 0);
+        else if (arg == "--ops" && has_value)      ops = argv[++i];
+        else if (arg == "--json" && has_value)     json_path = argv[++i];
+        else if (arg == "--quick") { max_size = size_t(1) << 20; target_seconds = 0.01; }
+        else return usage();
+    }
+    min_size = std::max<size_t>(min_size, 1);
+    const auto wanted = [&](const std::string& name) {
+        return ("," + ops + ",").find("," + name + ",") != std::string::npos;
+    };
+
+    std::cout << "jsHash column kernel: " << jsHash::column_kernel_name()
+        << ", ChaCha20 kernel: " << ChaCha::ChaCha20::kernel_name() << "\n";
+    if (pin_to_core(core))
+        std::cout << "Thread pinned to CPU core " << core << ".\n";
+    else
+        std::cout << "Thread not pinned (affinity not available).\n";
+
+    CycleCounter cycles;
+    std::cout << "Cycle source: " << cycles.source()
+        << (std::strcmp(cycles.source(), "tsc") == 0 ? " (reference cycles, not core cycles)" : "") << "\n\n";
+
+    // One 64-byte aligned buffer for the largest size, plus room for the +1 offset.
+    std::unique_ptr<uint8_t[]> storage(new uint8_t[max_size + 128]);
+    uint8_t* base = storage.get() + (64 - (reinterpret_cast<uintptr_t>(storage.get()) & 63));
+    std::mt19937_64 mt(54321);
+    for (size_t i = 0; i < max_size + 1; i += 8) {
+        const uint64_t r = mt();
+        std::memcpy(base + i, &r, std::min<size_t>(8, max_size + 1 - i));
+    }
+    std::vector<uint8_t> scratch(size_t(64) << 20);   // eviction buffer, larger than LLC
+
+    std::vector<Result> results;
+    std::cout << std::left << std::setw(10) << "op" << std::right << std::setw(12) << "bytes"
+        << std::setw(10) << "align" << std::setw(6) << "cache"
+        << std::setw(14) << "ns/op" << std::setw(10) << "GB/s" << std::setw(10) << "cyc/B" << "\n";
+
+    for (const Op& op : all_ops) {
+        if (!wanted(op.name)) continue;
+        for (size_t n = min_size; n <= max_size; n *= 4) {
+            for (bool aligned : { true, false }) {
+                for (bool cold : { false, true }) {
+                    Result r = measure(op, base + (aligned ? 0 : 1), n, aligned, cold,
+                        target_seconds, scratch, cycles);
+                    print(r);
+                    results.push_back(r);
+                }
+            }
+            if (n > max_size / 4) break;    // avoid overflow of n *= 4
+        }
+    }
+
+    if (wanted("latency")) {
+        for (const Result& r : measure_latency(cycles)) {
+            print(r);
+            results.push_back(r);
+        }
+    }
+
+    if (wanted("map")) {
+        for (const Result& r : measure_maps(cycles)) {
+            print(r);
+            results.push_back(r);
+        }
+    }
+
+    if (!json_path.empty()) {
+        write_json(json_path, results, cycles.source(), core);
+        std::cout << "\nWrote " << results.size() << " results to " << json_path << "\n";
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+#pragma once
+// file cpu_features.h
+// MIT License. Copyright (c) 2025 Jim Staley. See LICENSE for details.
+
+/*
+file cpu_features.h
+
+Runtime detection of the x86 SIMD extensions used by the optional vector
+kernels in jsHash.h and ChaChaEncryptor.h.
+
+    const cpu_features::Features& f = cpu_features::get();
+    if (f.avx2) { ... }
+
+A feature is only reported when both the CPU supports it and the operating
+system saves the matching register state (checked with xgetbv). On non-x86
+targets every flag is false.
+*/
+
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#   include <intrin.h>  // __cpuid, __cpuidex, _xgetbv
+#   define CPU_FEATURES_X86 1
+#elif defined(__x86_64__) || defined(__i386__)
+#   include <cpuid.h>   // __cpuid, __cpuid_count
+#   define CPU_FEATURES_X86 1
+#else
+#   define CPU_FEATURES_X86 0
+#endif
+
+namespace cpu_features {
+
+    struct Features {
+        bool sse2 = false;
+        bool avx2 = false;
+        bool avx512f = false;
+        bool avx512dq = false;
+        bool avx512bw = false;
+        bool avx512vl = false;
+        bool avx512ifma = false;
+    };
+
+#if CPU_FEATURES_X86
+    // regs[] = { eax, ebx, ecx, edx }
+    inline void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4]) noexcept {
+#if defined(_MSC_VER)
+        int r[4];
+        __cpuidex(r, (int)leaf, (int)subleaf);
+        for (int i = 0; i < 4; ++i) regs[i] = (uint32_t)r[i];
+#else
+        __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+
+    // Extended control register 0: which register files the OS saves on a context switch.
+    inline uint64_t xgetbv0() noexcept {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        uint32_t lo, hi;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        return ((uint64_t)hi << 32) | lo;
+#endif
+    }
+#endif
+
+    inline Features detect() noexcept {
+        Features f;
+#if CPU_FEATURES_X86
+        uint32_t r[4];
+        cpuid(0, 0, r);
+        const uint32_t max_leaf = r[0];
+
+        cpuid(1, 0, r);
+        f.sse2 = (r[3] >> 26) & 1;
+        const bool osxsave = (r[2] >> 27) & 1;
+        const bool avx = (r[2] >> 28) & 1;
+        if (!osxsave || !avx || max_leaf < 7)
+            return f;
+
+        const uint64_t xcr0 = xgetbv0();
+        const bool os_avx = (xcr0 & 0x06) == 0x06;      // XMM + YMM state
+        const bool os_avx512 = (xcr0 & 0xE6) == 0xE6;   // + opmask, ZMM_Hi256, Hi16_ZMM
+
+        cpuid(7, 0, r);
+        f.avx2 = os_avx && ((r[1] >> 5) & 1);
+        if (os_avx512) {
+            f.avx512f = (r[1] >> 16) & 1;
+            f.avx512dq = f.avx512f && ((r[1] >> 17) & 1);
+            f.avx512ifma = f.avx512f && ((r[1] >> 21) & 1);
+            f.avx512bw = f.avx512f && ((r[1] >> 30) & 1);
+            f.avx512vl = f.avx512f && ((r[1] >> 31) & 1);
+        }
+#endif
+        return f;
+    }
+
+    // Detected once, on first use.
+    inline const Features& get() noexcept {
+        static const Features features = detect();
+        return features;
+    }
+
+} // namespace cpu_features
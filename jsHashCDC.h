@@ -0,0 +1,176 @@
+#pragma once
+// file jsHashCDC.h
+// MIT License. Copyright (c) 2025 Jim Staley. See LICENSE for details.
+
+/*
+file jsHashCDC.h
+
+Content-defined chunking with jsHash digests, in one pass.
+
+    jsHashCDC cdc(seed);
+    cdc.update(data, n, [](const jsHashCDC::Chunk& c) { store(c); });  // any number of calls
+    cdc.finish([](const jsHashCDC::Chunk& c) { store(c); });
+
+Each Chunk has its offset in the stream, its length and its digest,
+    c.hash == jsHash(seed).insert(chunk bytes).hash256()
+so chunks can be deduplicated by digest. Boundaries depend only on the
+content and the seed, not on how the stream is split into update() calls.
+
+Boundary rule (FastCDC with normalized chunking, level 2)
+    • a rolling gear hash fp = (fp << 1) + Gear[byte] looks at the last
+      64 bytes; the 256-entry Gear table comes from SplitMix64(seed ^ GearDomain)
+    • the first min_size bytes of a chunk are never cut (and not scanned)
+    • below avg_size a cut needs log2(avg)+2 zero bits of fp (rare),
+      from avg_size on it needs log2(avg)-2 (common), so sizes cluster
+      around avg_size
+    • a chunk is always cut at max_size
+
+Params are normalized by the constructor (see parameters()): avg_size is
+rounded down to a power of two in [MinAvg, MaxAvg], then min_size is
+lowered to at most avg_size and max_size raised to at least avg_size.
+
+One pass over the data: the input is taken in slices of at most
+SliceSize bytes. Each slice is scanned for a boundary and the scanned
+bytes are inserted into the chunk's jsHash right away, while they are
+still in L1. The data is never copied.
+*/
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "jsHash.h"
+
+class jsHashCDC {
+public:
+    struct Params {
+        size_t min_size = 2 * 1024;
+        size_t avg_size = 8 * 1024;     // power of two
+        size_t max_size = 64 * 1024;
+    };
+
+    struct Chunk {
+        uint64_t offset;                // position of the first byte in the stream
+        size_t   length;
+        std::array<uint64_t, 4> hash;   // jsHash(seed) over the chunk, hash256()
+    };
+
+    static constexpr size_t   SliceSize = 4096;
+    static constexpr size_t   MinAvg = 64;                      // the gear hash window
+    static constexpr size_t   MaxAvg = size_t(1) << (sizeof(size_t) * 8 - 4);
+    static constexpr uint64_t GearDomain = 0x72616567a5a5c3d1ULL;   // keeps Gear apart from jsHash(seed)'s lanes
+
+private:
+    std::array<uint64_t, 256> gear;
+    Params params;
+    uint64_t mask_small;    // needed below avg_size (more bits → rarer cut)
+    uint64_t mask_large;    // needed from avg_size on
+    jsHashKey key;          // for starting each chunk's hasher
+
+    jsHash   hasher;
+    uint64_t fp = 0;        // rolling gear hash
+    size_t   len = 0;       // bytes in the current chunk
+    uint64_t offset = 0;    // stream offset of the current chunk
+
+public:
+    explicit jsHashCDC(uint64_t seed_ = 42) : jsHashCDC(seed_, Params()) {}
+
+    jsHashCDC(uint64_t seed_, const Params& p)
+        : params(normalized(p)), key(seed_), hasher(key)
+    {
+        jsHash::SplitMix64 gen(seed_ ^ GearDomain);
+        for (auto& g : gear) g = gen();
+
+        const int bits = std::bit_width(params.avg_size) - 1;     // log2(avg), 6 or more
+        mask_small = top_bits(bits + 2);
+        mask_large = top_bits(bits - 2);
+    }
+
+    // The sizes in use, after normalization.
+    const Params& parameters() const noexcept { return params; }
+
+    // Feeds n bytes; calls sink(const Chunk&) for every chunk that ends inside them.
+    template <typename Sink>
+    void update(const uint8_t* data, size_t n, Sink&& sink) {
+        while (n > 0) {
+            const size_t slice = std::min(n, SliceSize);
+            bool cut = false;
+            const size_t used = scan(data, slice, cut);
+
+            hasher.insert(data, used);
+            len += used;
+            data += used;
+            n -= used;
+
+            if (cut)
+                emit(sink);
+        }
+    }
+
+    // Emits the last (possibly short) chunk and ends the stream; the chunker
+    // can then start a new stream at offset 0.
+    template <typename Sink>
+    void finish(Sink&& sink) {
+        if (len > 0)
+            emit(sink);
+        offset = 0;
+    }
+
+    // Convenience: all chunks of one buffer.
+    std::vector<Chunk> chunk_all(const void* data, size_t n) {
+        std::vector<Chunk> chunks;
+        auto push = [&](const Chunk& c) { chunks.push_back(c); };
+        update(static_cast<const uint8_t*>(data), n, push);
+        finish(push);
+        return chunks;
+    }
+
+private:
+    static constexpr Params normalized(Params p) noexcept {
+        p.avg_size = std::bit_floor(std::clamp(p.avg_size, MinAvg, MaxAvg));
+        p.min_size = std::min(p.min_size, p.avg_size);
+        p.max_size = std::max(p.max_size, p.avg_size);
+        return p;
+    }
+
+    static constexpr uint64_t top_bits(int k) noexcept {
+        return ~0ULL << (64 - k);
+    }
+
+    // Scans up to n bytes of the current chunk. Returns how many belong to it;
+    // cut is set when the chunk ends after the last of those bytes.
+    size_t scan(const uint8_t* p, size_t n, bool& cut) noexcept {
+        // Bytes before min_size are skipped entirely.
+        size_t i = (len < params.min_size) ? std::min(n, params.min_size - len) : 0;
+        if (len + i >= params.max_size) {       // min_size == max_size
+            cut = true;
+            return i;
+        }
+
+        uint64_t h = fp;
+        for (; i < n; ++i) {
+            h = (h << 1) + gear[p[i]];
+            const size_t chunk_len = len + i + 1;
+            const uint64_t mask = (chunk_len < params.avg_size) ? mask_small : mask_large;
+            if ((h & mask) == 0 || chunk_len >= params.max_size) {
+                fp = h;
+                cut = true;
+                return i + 1;
+            }
+        }
+        fp = h;
+        return n;
+    }
+
+    template <typename Sink>
+    void emit(Sink& sink) {
+        sink(Chunk{ offset, len, hasher.hash256() });
+        offset += len;
+        len = 0;
+        fp = 0;
+        hasher.reset(key);
+    }
+};
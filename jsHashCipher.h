@@ -0,0 +1,124 @@
+#pragma once
+// file jsHashCipher.h
+// MIT License. Copyright (c) 2025 Jim Staley. See LICENSE for details.
+
+/*
+file jsHashCipher.h
+
+ChaCha20 encryption with a jsHash secure tag over the ciphertext, in one
+pass over memory.
+
+    jsHashCipher enc(key, nonce, secret_seed);
+    enc.encrypt(out, in, n);                    // any number of calls
+    auto tag = enc.tag();                       // 256-bit, hash_secure<4>
+
+    jsHashCipher dec(key, nonce, secret_seed);
+    dec.decrypt(out, in, n);
+    if (!dec.verify(tag)) ...                   // reject the message
+
+What is computed
+    • ciphertext = ChaCha20(key, nonce, initial_counter = 2) ^ plaintext
+    • tag        = jsHash(seed).insert(ciphertext).hash_secure<N>(key, nonce)
+    hash_secure() encrypts with keystream block 1 of (key, nonce), so the
+    cipher starts at block 2 and the two never share keystream (the same
+    split as RFC 8439, which keeps block 0 for the Poly1305 key). A
+    ciphertext from plain ChaCha20::crypt (counter 1) is NOT compatible.
+
+The seed must be secret
+    hash_secure() is the jsHash lane state XOR keystream block 1, and
+    the jsHash part is not keyed by the ChaCha key. Anyone who knows the
+    seed can hash a ciphertext, so one (ciphertext, tag) pair gives away
+    the keystream block that masks the tag (tag ^ their own hash), and
+    with it a valid tag for ANY other ciphertext under the same key and
+    nonce. That is why the seed has no default: keep it as secret as the
+    key. Even then the tag is not a proven MAC (jsHash is not a reviewed
+    PRF), and tag<8>() gives away keystream words 4..7 outright, since
+    those block words are the length and public constants.
+
+One pass
+    The input is taken ChunkBytes at a time. Each chunk is encrypted
+    (wide keystream kernels) and the ciphertext is absorbed into the
+    jsHash lanes right away, while it is still in L1. Decryption hashes
+    the chunk first, then decrypts it. in == out is allowed.
+
+Like hash_secure itself, this is not a reviewed AEAD construction; see
+the Security Notice in jsHash.h. Use ChaCha20-Poly1305 where that matters.
+*/
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "jsHash.h"
+
+class jsHashCipher {
+public:
+    static constexpr size_t   ChunkBytes = 4096;
+    static constexpr uint64_t FirstBlock = 2;   // block 1 is the tag's
+
+private:
+    ChaCha::ChaCha20  cipher;
+    jsHash            hasher;
+    ChaCha::ChaChaKey key;
+    ChaCha::ChaChaNonce nonce;
+
+public:
+    // secret_seed: see "The seed must be secret" above.
+    jsHashCipher(const ChaCha::ChaChaKey& key_, const ChaCha::ChaChaNonce& nonce_, uint64_t secret_seed)
+        : cipher(key_, nonce_, FirstBlock), hasher(secret_seed), key(key_), nonce(nonce_) {}
+
+    // Key material lives in key, in the cipher's state and keystream, and
+    // (through the seed) in the hasher's lanes; all of it is wiped.
+    ~jsHashCipher() {
+        ChaCha::wipe(&key, sizeof(key));
+        ChaCha::wipe(&cipher, sizeof(cipher));
+        ChaCha::wipe(&hasher, sizeof(hasher));
+    }
+
+    jsHashCipher(const jsHashCipher&) = delete;
+    jsHashCipher& operator=(const jsHashCipher&) = delete;
+
+    void encrypt(uint8_t* out, const uint8_t* in, size_t n) noexcept {
+        while (n > 0) {
+            const size_t c = std::min(n, ChunkBytes);
+            cipher.crypt(out, in, c);
+            hasher.insert(out, c);
+            out += c;
+            in += c;
+            n -= c;
+        }
+    }
+
+    void decrypt(uint8_t* out, const uint8_t* in, size_t n) noexcept {
+        while (n > 0) {
+            const size_t c = std::min(n, ChunkBytes);
+            hasher.insert(in, c);
+            cipher.crypt(out, in, c);
+            out += c;
+            in += c;
+            n -= c;
+        }
+    }
+
+    void encrypt(uint8_t* data, size_t n) noexcept { encrypt(data, data, n); }
+    void decrypt(uint8_t* data, size_t n) noexcept { decrypt(data, data, n); }
+
+    // Tag over all ciphertext so far; N words (2, 4 or 8).
+    template <size_t N = 4>
+    std::array<uint64_t, N> tag() const noexcept {
+        return hasher.hash_secure<N>(key, nonce);
+    }
+
+    // Compares every word (no early exit), so the timing does not show
+    // where a forged tag goes wrong. This does not make the tag a MAC;
+    // see "The seed must be secret" above.
+    template <size_t N>
+    bool verify(const std::array<uint64_t, N>& expected) const noexcept {
+        const std::array<uint64_t, N> t = tag<N>();
+        uint64_t diff = 0;
+        for (size_t i = 0; i < N; ++i)
+            diff |= t[i] ^ expected[i];
+        return diff == 0;
+    }
+};
@@ -0,0 +1,201 @@
+#pragma once
+// file jsHashFile.h
+// MIT License. Copyright (c) 2025 Jim Staley. See LICENSE for details.
+
+/*
+file jsHashFile.h
+
+Hashing whole files with jsHash.
+
+    std::optional<uint64_t>                HashFile(path, seed = 42)
+    std::optional<std::array<uint64_t, 4>> HashFile256(path, seed = 42)
+
+The values are the same as hashing the file's bytes in memory
+(HashFile(path, s) == Hash64(contents, size, s)). On failure the result
+is empty and errno describes the error.
+
+How the file is read
+    • POSIX, regular file: mmap the whole file read-only, with
+      MADV_SEQUENTIAL (aggressive read-ahead) and MADV_HUGEPAGE where the
+      kernel offers it, and insert() it in one call.
+    • Anything else (pipes, character devices, failed mmap, non-POSIX
+      hosts): a double-buffered read loop. One reader thread, started
+      per file, reads the next 1 MiB block while the current one is
+      hashed.
+*/
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "jsHash.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   define JSHASH_POSIX_FILES 1
+#else
+#   define JSHASH_POSIX_FILES 0
+#endif
+
+namespace jsHashFile {
+
+    static constexpr size_t ReadBlock = size_t(1) << 20;   // read-loop block size
+
+    // Reads with read_fn(buffer, capacity) → bytes read (0 at end, < 0 on error)
+    // into two alternating buffers; block k+1 is read while block k is hashed.
+    // read_fn runs on one reader thread for the whole file.
+    template <typename ReadFn>
+    inline bool hash_read_loop(jsHash& h, ReadFn read_fn) {
+        struct Buffer {
+            std::vector<uint8_t> data = std::vector<uint8_t>(ReadBlock);
+            long long got = 0;
+            int error = 0;              // the reader's errno when got < 0
+            bool full = false;          // read, not yet hashed
+        } buffers[2];
+        std::mutex m;
+        std::condition_variable cv;
+
+        std::thread reader([&] {
+            for (int cur = 0; ; cur ^= 1) {
+                Buffer& b = buffers[cur];
+                {
+                    std::unique_lock<std::mutex> lock(m);
+                    cv.wait(lock, [&] { return !b.full; });
+                }
+                const long long got = read_fn(b.data.data(), ReadBlock);
+                const int error = errno;
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    b.got = got;
+                    b.error = error;
+                    b.full = true;
+                }
+                cv.notify_all();
+                if (got <= 0)
+                    return;
+            }
+        });
+
+        long long got;
+        for (int cur = 0; ; cur ^= 1) {
+            Buffer& b = buffers[cur];
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [&] { return b.full; });
+                got = b.got;
+            }
+            if (got <= 0) {
+                if (got < 0)
+                    errno = b.error;    // errno is per thread
+                break;
+            }
+            h.insert(b.data.data(), (size_t)got);
+            {
+                std::lock_guard<std::mutex> lock(m);
+                b.full = false;
+            }
+            cv.notify_all();
+        }
+        reader.join();
+        return got == 0;
+    }
+
+#if JSHASH_POSIX_FILES
+    // Hashes fd from its current offset to the end, as reading it would.
+    inline bool hash_fd(jsHash& h, int fd) {
+        const off_t start = lseek(fd, 0, SEEK_CUR);     // -1: pipes cannot seek
+        struct stat st;
+        if (start != (off_t)-1 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            const size_t size = (size_t)st.st_size;
+            if (st.st_size <= start)
+                return true;
+            void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                madvise(map, size, MADV_SEQUENTIAL);
+#if defined(MADV_HUGEPAGE)
+                madvise(map, size, MADV_HUGEPAGE);   // only a hint; EINVAL is fine
+#endif
+                h.insert(static_cast<const uint8_t*>(map) + start, size - (size_t)start);
+                munmap(map, size);
+                return true;
+            }
+        }
+
+        // Fallback: read loop. pread() from start keeps the two reads
+        // independent of the file offset; pipes use read().
+        off_t offset = start;
+        const bool seekable = start != (off_t)-1;
+        return hash_read_loop(h, [&](uint8_t* buf, size_t cap) -> long long {
+            for (;;) {
+                ssize_t r = seekable ? pread(fd, buf, cap, offset) : read(fd, buf, cap);
+                if (r < 0 && errno == EINTR) continue;
+                if (r > 0) offset += r;
+                return (long long)r;
+            }
+        });
+    }
+#endif
+
+    // Streams the file into h. "-" means standard input.
+    inline bool hash_file(jsHash& h, const std::string& path) {
+#if JSHASH_POSIX_FILES
+        if (path == "-")
+            return hash_fd(h, STDIN_FILENO);
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        const bool ok = hash_fd(h, fd);
+        const int saved = errno;
+        close(fd);
+        errno = saved;
+        return ok;
+#else
+        std::FILE* f = (path == "-") ? stdin : std::fopen(path.c_str(), "rb");
+        if (!f)
+            return false;
+        const bool ok = hash_read_loop(h, [&](uint8_t* buf, size_t cap) -> long long {
+            size_t r = std::fread(buf, 1, cap, f);
+            return (r == 0 && std::ferror(f)) ? -1 : (long long)r;
+        });
+        if (f != stdin)
+            std::fclose(f);
+        return ok;
+#endif
+    }
+
+} // namespace jsHashFile
+
+/*----------------------------------------------------------------*
+   1-liner API for files
+
+       if (auto h = HashFile("data.bin", 42))
+           std::cout << *h << "\n";
+ ----------------------------------------------------------------*/
+[[nodiscard]] inline std::optional<std::array<uint64_t, 4>>
+    HashFile256(const std::string& path, uint64_t seed = 42)
+{
+    jsHash h(seed);
+    if (!jsHashFile::hash_file(h, path))
+        return std::nullopt;
+    return std::move(h).hash256();
+}
+
+[[nodiscard]] inline std::optional<uint64_t>
+    HashFile(const std::string& path, uint64_t seed = 42)
+{
+    jsHash h(seed);
+    if (!jsHashFile::hash_file(h, path))
+        return std::nullopt;
+    return std::move(h).hash64();
+}
@@ -0,0 +1,617 @@
+#pragma once
+// file jsHashMap.h
+// MIT License. Copyright (c) 2025 Jim Staley. See LICENSE for details.
+
+/*
+file jsHashMap.h
+
+Open-addressing flat hash map and set keyed with jsHash (SwissTable layout).
+
+    jsHashMap::FlatMap<std::string, int> m;
+    m["apple"] = 1;
+    m.try_emplace("pear", 2);
+    if (auto it = m.find(std::string_view("apple")); it != m.end()) ...
+
+    jsHashMap::FlatSet<uint64_t> s;
+    s.insert(42);
+
+Layout
+    • Slots live in one flat array; there is no node per element and no
+      pointer chasing. Next to it is one control byte per slot:
+          0..127   full, holding 7 bits of the key's hash (the tag)
+          Empty    never used since the last rehash
+          Deleted  erased (a tombstone; lookups probe past it)
+    • A key's hash128 gives both parts: word 0 picks the start slot,
+      7 bits of word 1 are the tag. The two words are independent
+      outputs of the cross-mixed lanes, so slot and tag do not correlate.
+    • Lookups test GroupWidth (16) control bytes at once. With SSE2 this
+      is one compare + movemask; only slots whose tag matches are
+      compared with the key, so a miss almost never touches a slot.
+      Groups are probed triangularly (+16, +32, +48, ...), which visits
+      every group of the power-of-two table exactly once.
+    • The table grows (doubles) at 7/8 load. Erase leaves a tombstone;
+      when tombstones rather than elements fill the table, it is
+      rehashed at the same size.
+
+Heterogeneous lookup
+    The default Hasher and std::equal_to<> are transparent. find(),
+    contains(), count(), erase(), try_emplace() and operator[] take any
+    key type that hashes and compares like the stored key. A
+    FlatMap<std::string, V> is searched with a std::string_view or a
+    C string without building a std::string. An integer of another type
+    is converted to the key type before it is hashed, so it is found
+    exactly when std::equal_to<> says it equals a stored key: a
+    FlatMap<uint64_t, V> is found with an int, and -1 finds the key
+    0xFFFFFFFF in a FlatMap<uint32_t, V>.
+
+Iterators and references are invalidated by any insertion that rehashes
+and by clear()/reserve(). Erase never moves other elements.
+*/
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "jsHash.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define JSHASH_MAP_SSE2 1
+#else
+#   define JSHASH_MAP_SSE2 0
+#endif
+
+namespace jsHashMap {
+
+    /*----------------------------------------------------------------*
+     *  Hasher – jsHash hash128 of the key
+     *
+     *  • string-like keys (std::string, std::string_view, C strings)
+     *    hash their characters, so they all agree;
+     *  • integers and enums hash their value converted to uint64_t
+     *    (signed values sign-extend). Equal values of different widths
+     *    or signedness can therefore hash differently; Table converts an
+     *    integer lookup key to the stored key type first (see hash_of);
+     *  • other types with a unique object representation hash their bytes.
+     *----------------------------------------------------------------*/
+    struct Hasher {
+        using is_transparent = void;
+
+        uint64_t seed = 42;
+
+        std::array<uint64_t, 2> operator()(std::string_view s) const noexcept {
+            return jsHash::hash128_oneshot(s.data(), s.size(), seed);
+        }
+
+        template <typename K>
+            requires (std::is_integral_v<K> || std::is_enum_v<K>)
+        std::array<uint64_t, 2> operator()(K k) const noexcept {
+            uint64_t x;
+            if constexpr (std::is_enum_v<K>)
+                x = (uint64_t)(std::underlying_type_t<K>)k;
+            else
+                x = (uint64_t)k;       // signed values sign-extend
+            return jsHash::hash128_oneshot(&x, sizeof(x), seed);
+        }
+
+        template <typename K>
+            requires (std::has_unique_object_representations_v<K>
+                && !std::is_integral_v<K> && !std::is_enum_v<K>
+                && !std::is_pointer_v<K> && !std::is_array_v<K>)
+        std::array<uint64_t, 2> operator()(const K& k) const noexcept {
+            return jsHash::hash128_oneshot(&k, sizeof(K), seed);
+        }
+    };
+
+    /*----------------------------------------------------------------*
+     *  Control bytes and group matching
+     *----------------------------------------------------------------*/
+    static constexpr int8_t Empty = -128;      // 0b10000000
+    static constexpr int8_t Deleted = -2;      // 0b11111110
+    static constexpr size_t GroupWidth = 16;
+
+    // Bit i of a mask refers to control byte i of the group.
+    struct Group {
+#if JSHASH_MAP_SSE2
+        __m128i ctrl;
+
+        explicit Group(const int8_t* p) noexcept
+            : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+
+        uint32_t match(int8_t tag) const noexcept {
+            return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag)));
+        }
+        uint32_t match_empty() const noexcept {
+            return match(Empty);
+        }
+        // Empty and Deleted are the only negative control bytes.
+        uint32_t match_free() const noexcept {
+            return (uint32_t)_mm_movemask_epi8(ctrl);
+        }
+#else
+        int8_t ctrl[GroupWidth];
+
+        explicit Group(const int8_t* p) noexcept {
+            std::memcpy(ctrl, p, GroupWidth);
+        }
+
+        uint32_t match(int8_t tag) const noexcept {
+            uint32_t m = 0;
+            for (size_t i = 0; i < GroupWidth; ++i)
+                m |= uint32_t(ctrl[i] == tag) << i;
+            return m;
+        }
+        uint32_t match_empty() const noexcept {
+            return match(Empty);
+        }
+        uint32_t match_free() const noexcept {
+            uint32_t m = 0;
+            for (size_t i = 0; i < GroupWidth; ++i)
+                m |= uint32_t(ctrl[i] < 0) << i;
+            return m;
+        }
+#endif
+    };
+
+    /*----------------------------------------------------------------*
+     *  Table – the storage and probing shared by FlatMap and FlatSet
+     *
+     *  Slot is the stored element and KeyOf::view(slot) the Value users
+     *  see; KeyOf::get(slot) returns the key. The control array has
+     *  capacity + GroupWidth bytes: the last GroupWidth mirror the first
+     *  ones, so a group starting anywhere in the table can be loaded with
+     *  one unaligned read.
+     *
+     *  A slot is marked full only after its element is constructed, and a
+     *  rehash builds the new arrays completely before it drops the old
+     *  ones, so a throwing constructor or allocation leaves the table as
+     *  it was.
+     *----------------------------------------------------------------*/
+    template <typename Slot, typename Key, typename KeyOf, typename Hash, typename Eq>
+    class Table {
+    protected:
+        using Value = typename KeyOf::Value;
+        static constexpr size_t npos = ~size_t(0);
+
+        static constexpr bool transparent = requires {
+            typename Hash::is_transparent;
+            typename Eq::is_transparent;
+        };
+
+        // Heterogeneous keys only with a transparent hasher and equality.
+        template <typename K>
+        static constexpr bool lookup_key = transparent || std::is_same_v<std::remove_cvref_t<K>, Key>;
+
+        int8_t* ctrl = empty_group();
+        Slot*   slots = nullptr;
+        size_t  cap = 0;            // 0 or a power of two >= GroupWidth
+        size_t  used = 0;           // full slots
+        size_t  growth_left = 0;    // Empty slots that may still be filled before a rehash
+        Hash    hash;
+        Eq      eq;
+
+    public:
+        template <bool Const>
+        class Iterator {
+            friend class Table;
+            friend class Iterator<!Const>;
+            using TablePtr = std::conditional_t<Const, const Table*, Table*>;
+            TablePtr t = nullptr;
+            size_t i = 0;
+
+            Iterator(TablePtr t_, size_t i_) noexcept : t(t_), i(i_) { skip(); }
+            void skip() noexcept {
+                while (i < t->cap && t->ctrl[i] < 0) ++i;
+            }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::remove_const_t<Value>;
+            using difference_type = std::ptrdiff_t;
+            using reference = std::conditional_t<Const, const Value&, Value&>;
+            using pointer = std::conditional_t<Const, const Value*, Value*>;
+
+            Iterator() = default;
+            operator Iterator<true>() const noexcept { return Iterator<true>(t, i); }
+
+            reference operator*() const noexcept { return KeyOf::view(t->slots[i]); }
+            pointer operator->() const noexcept { return &KeyOf::view(t->slots[i]); }
+            Iterator& operator++() noexcept { ++i; skip(); return *this; }
+            Iterator operator++(int) noexcept { Iterator old = *this; ++*this; return old; }
+            bool operator==(const Iterator& o) const noexcept { return i == o.i; }
+        };
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        explicit Table(const Hash& h = Hash(), const Eq& e = Eq()) : hash(h), eq(e) {}
+
+        Table(const Table& other) : hash(other.hash), eq(other.eq) {
+            try {
+                reserve(other.used);
+                for (size_t i = 0; i < other.cap; ++i) {
+                    if (other.ctrl[i] < 0)
+                        continue;
+                    const std::array<uint64_t, 2> h = hash(KeyOf::get(other.slots[i]));
+                    place(h, find_free(h), [&](Slot* p) { std::construct_at(p, other.slots[i]); });
+                }
+            }
+            catch (...) {
+                destroy();      // no destructor runs for a constructor that throws
+                throw;
+            }
+        }
+
+        Table(Table&& other) noexcept
+            : ctrl(other.ctrl), slots(other.slots), cap(other.cap), used(other.used),
+              growth_left(other.growth_left), hash(std::move(other.hash)), eq(std::move(other.eq))
+        {
+            other.release();
+        }
+
+        Table& operator=(Table other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        ~Table() { destroy(); }
+
+        void swap(Table& other) noexcept {
+            std::swap(ctrl, other.ctrl);
+            std::swap(slots, other.slots);
+            std::swap(cap, other.cap);
+            std::swap(used, other.used);
+            std::swap(growth_left, other.growth_left);
+            std::swap(hash, other.hash);
+            std::swap(eq, other.eq);
+        }
+
+        size_t size() const noexcept { return used; }
+        bool empty() const noexcept { return used == 0; }
+        size_t capacity() const noexcept { return cap; }
+
+        iterator begin() noexcept { return iterator(this, 0); }
+        iterator end() noexcept { return iterator(this, cap); }
+        const_iterator begin() const noexcept { return const_iterator(this, 0); }
+        const_iterator end() const noexcept { return const_iterator(this, cap); }
+
+        void clear() noexcept {
+            destroy();
+            release();
+        }
+
+        // Room for n elements without a rehash.
+        void reserve(size_t n) {
+            size_t want = GroupWidth;
+            while (want - want / 8 < n)
+                want *= 2;
+            if (want > cap)
+                resize(want);
+        }
+
+        template <typename K> requires lookup_key<K>
+        iterator find(const K& key) noexcept {
+            return iterator(this, find_index(key));
+        }
+        template <typename K> requires lookup_key<K>
+        const_iterator find(const K& key) const noexcept {
+            return const_iterator(this, find_index(key));
+        }
+        template <typename K> requires lookup_key<K>
+        bool contains(const K& key) const noexcept {
+            return find_index(key) != cap;
+        }
+        template <typename K> requires lookup_key<K>
+        size_t count_of(const K& key) const noexcept {
+            return contains(key) ? 1 : 0;
+        }
+
+        template <typename K> requires lookup_key<K>
+        size_t erase(const K& key) {
+            const size_t i = find_index(key);
+            if (i == cap)
+                return 0;
+            erase_at(i);
+            return 1;
+        }
+
+        iterator erase(const_iterator it) {
+            erase_at(it.i);
+            return iterator(this, it.i + 1);
+        }
+
+    protected:
+        iterator iterator_at(size_t i) noexcept { return iterator(this, i); }
+
+        static int8_t* empty_group() noexcept {
+            alignas(16) static int8_t group[GroupWidth] = {
+                Empty, Empty, Empty, Empty, Empty, Empty, Empty, Empty,
+                Empty, Empty, Empty, Empty, Empty, Empty, Empty, Empty };
+            return group;
+        }
+
+        static int8_t tag_of(const std::array<uint64_t, 2>& h) noexcept {
+            return int8_t(h[1] & 0x7f);
+        }
+
+        // An integer looked up in a table of integers is hashed as the value
+        // converted to Key. std::equal_to<> compares after the usual
+        // arithmetic conversions, and whenever it finds key == k the
+        // conversion gives Key(k) == key, so equal keys always hash alike
+        // (-1 finds 0xFFFFFFFFu in a FlatMap<uint32_t, V>).
+        template <typename K>
+        std::array<uint64_t, 2> hash_of(const K& key) const noexcept {
+            if constexpr (std::is_integral_v<Key> && std::is_integral_v<K>)
+                return hash(static_cast<Key>(key));
+            else
+                return hash(key);
+        }
+
+        void set_ctrl(size_t i, int8_t c) noexcept {
+            ctrl[i] = c;
+            if (i < GroupWidth)
+                ctrl[cap + i] = c;      // mirror
+        }
+
+        // Index of the key's slot, or cap when absent.
+        template <typename K>
+        size_t find_index(const K& key) const noexcept {
+            if (used == 0)
+                return cap;
+            return find_index(key, hash_of(key));
+        }
+
+        // Same, with h == hash_of(key) already computed.
+        template <typename K>
+        size_t find_index(const K& key, const std::array<uint64_t, 2>& h) const noexcept {
+            if (used == 0)
+                return cap;
+            const int8_t tag = tag_of(h);
+            const size_t mask = cap - 1;
+            size_t pos = h[0] & mask;
+            for (size_t step = GroupWidth; ; step += GroupWidth) {
+                const Group g(ctrl + pos);
+                for (uint32_t m = g.match(tag); m; m &= m - 1) {
+                    const size_t i = (pos + std::countr_zero(m)) & mask;
+                    if (eq(KeyOf::get(slots[i]), key))
+                        return i;
+                }
+                if (g.match_empty())
+                    return cap;
+                pos = (pos + step) & mask;
+            }
+        }
+
+        // First Empty or Deleted slot on the probe path of h.
+        size_t find_free(const std::array<uint64_t, 2>& h) const noexcept {
+            const size_t mask = cap - 1;
+            size_t pos = h[0] & mask;
+            for (size_t step = GroupWidth; ; step += GroupWidth) {
+                const uint32_t m = Group(ctrl + pos).match_free();
+                if (m)
+                    return (pos + std::countr_zero(m)) & mask;
+                pos = (pos + step) & mask;
+            }
+        }
+
+        // construct(slots + i) builds the element in free slot i; only then
+        // is the slot marked full. If construct throws, nothing has changed.
+        template <typename Construct>
+        void place(const std::array<uint64_t, 2>& h, size_t i, Construct&& construct) {
+            construct(slots + i);
+            if (ctrl[i] == Empty)
+                --growth_left;
+            set_ctrl(i, tag_of(h));
+            ++used;
+        }
+
+        // Finds key, or inserts the element construct(slot) builds for it.
+        // Returns {index, inserted}. The key is hashed once for both.
+        template <typename K, typename Construct>
+        std::pair<size_t, bool> find_or_insert(const K& key, Construct&& construct) {
+            const std::array<uint64_t, 2> h = hash_of(key);
+            const size_t found = find_index(key, h);
+            if (found != cap)
+                return { found, false };
+
+            size_t i = (cap == 0) ? npos : find_free(h);
+            if (i == npos || (growth_left == 0 && ctrl[i] == Empty)) {
+                grow();
+                i = find_free(h);
+            }
+            place(h, i, construct);
+            return { i, true };
+        }
+
+        void erase_at(size_t i) {
+            std::destroy_at(slots + i);
+            set_ctrl(i, Deleted);
+            --used;
+        }
+
+        // Doubles the table, or rehashes in place when it is mostly tombstones.
+        void grow() {
+            if (cap == 0)
+                resize(GroupWidth);
+            else if (used < (cap - cap / 8) / 2)
+                resize(cap);
+            else
+                resize(cap * 2);
+        }
+
+        // Empty arrays for n slots; on a table that owns none.
+        void allocate(size_t n) {
+            int8_t* c = std::allocator<int8_t>().allocate(n + GroupWidth);
+            Slot* s;
+            try {
+                s = std::allocator<Slot>().allocate(n);
+            }
+            catch (...) {
+                std::allocator<int8_t>().deallocate(c, n + GroupWidth);
+                throw;
+            }
+            std::memset(c, (uint8_t)Empty, n + GroupWidth);
+            ctrl = c;
+            slots = s;
+            cap = n;
+            used = 0;
+            growth_left = n - n / 8;
+        }
+
+        // The elements go into a second table first (moved, or copied when
+        // their move may throw); this one is only changed once that worked.
+        void resize(size_t new_cap) {
+            Table fresh(hash, eq);
+            fresh.allocate(new_cap);
+            for (size_t i = 0; i < cap; ++i) {
+                if (ctrl[i] < 0)
+                    continue;
+                const std::array<uint64_t, 2> h = hash(KeyOf::get(slots[i]));
+                fresh.place(h, fresh.find_free(h), [&](Slot* p) { KeyOf::relocate(p, slots[i]); });
+            }
+            destroy();
+            ctrl = fresh.ctrl;
+            slots = fresh.slots;
+            cap = fresh.cap;
+            used = fresh.used;
+            growth_left = fresh.growth_left;
+            fresh.release();
+        }
+
+        // Forgets the arrays without destroying anything.
+        void release() noexcept {
+            ctrl = empty_group();
+            slots = nullptr;
+            cap = used = growth_left = 0;
+        }
+
+        void destroy() noexcept {
+            if (cap == 0)
+                return;
+            if constexpr (!std::is_trivially_destructible_v<Slot>) {
+                for (size_t i = 0; i < cap; ++i)
+                    if (ctrl[i] >= 0)
+                        std::destroy_at(slots + i);
+            }
+            std::allocator<int8_t>().deallocate(ctrl, cap + GroupWidth);
+            std::allocator<Slot>().deallocate(slots, cap);
+        }
+    };
+
+    /*----------------------------------------------------------------*
+     *  FlatMap<Key, T> – elements are std::pair<const Key, T>
+     *
+     *  Slots hold std::pair<Key, T> and are handed out as
+     *  std::pair<const Key, T>, which has the same layout (the scheme of
+     *  the absl and Boost flat maps). The key is only ever changed by a
+     *  rehash, which moves it out of a slot that is destroyed right after.
+     *----------------------------------------------------------------*/
+    template <typename Key, typename T>
+    struct MapKeyOf {
+        using Slot = std::pair<Key, T>;
+        using Value = std::pair<const Key, T>;
+        static_assert(sizeof(Slot) == sizeof(Value) && alignof(Slot) == alignof(Value));
+
+        static const Key& get(const Slot& s) noexcept { return s.first; }
+        static Value& view(Slot& s) noexcept { return *std::launder(reinterpret_cast<Value*>(&s)); }
+        static const Value& view(const Slot& s) noexcept { return *std::launder(reinterpret_cast<const Value*>(&s)); }
+
+        static void relocate(Slot* dst, Slot& src) {
+            std::construct_at(dst, std::move_if_noexcept(src));
+        }
+    };
+
+    template <typename Key, typename T, typename Hash = Hasher, typename Eq = std::equal_to<>>
+    class FlatMap : public Table<std::pair<Key, T>, Key, MapKeyOf<Key, T>, Hash, Eq> {
+        using Base = Table<std::pair<Key, T>, Key, MapKeyOf<Key, T>, Hash, Eq>;
+        using Slot = std::pair<Key, T>;
+
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<const Key, T>;
+        using typename Base::iterator;
+        using typename Base::const_iterator;
+
+        using Base::Base;
+
+        // Inserts {key, T(args...)} unless key is present; never overwrites.
+        template <typename K, typename... Args> requires Base::template lookup_key<K>
+        std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+            auto [i, inserted] = this->find_or_insert(key, [&](Slot* p) {
+                std::construct_at(p, std::piecewise_construct,
+                    std::forward_as_tuple(std::forward<K>(key)),
+                    std::forward_as_tuple(std::forward<Args>(args)...));
+            });
+            return { this->iterator_at(i), inserted };
+        }
+
+        std::pair<iterator, bool> insert(const value_type& v) {
+            return try_emplace(v.first, v.second);
+        }
+        std::pair<iterator, bool> insert(value_type&& v) {
+            return try_emplace(v.first, std::move(v.second));
+        }
+
+        // Inserts or overwrites.
+        template <typename K, typename V> requires Base::template lookup_key<K>
+        std::pair<iterator, bool> insert_or_assign(K&& key, V&& value) {
+            auto r = try_emplace(std::forward<K>(key), std::forward<V>(value));
+            if (!r.second)
+                r.first->second = std::forward<V>(value);
+            return r;
+        }
+
+        template <typename K> requires Base::template lookup_key<K>
+        T& operator[](K&& key) {
+            return try_emplace(std::forward<K>(key)).first->second;
+        }
+
+        template <typename K> requires Base::template lookup_key<K>
+        size_t count(const K& key) const noexcept { return this->count_of(key); }
+    };
+
+    /*----------------------------------------------------------------*
+     *  FlatSet<Key> – elements are seen as const Key
+     *----------------------------------------------------------------*/
+    template <typename Key>
+    struct SetKeyOf {
+        using Value = const Key;
+        static const Key& get(const Key& s) noexcept { return s; }
+        static const Key& view(const Key& s) noexcept { return s; }
+        static void relocate(Key* dst, Key& src) { std::construct_at(dst, std::move_if_noexcept(src)); }
+    };
+
+    template <typename Key, typename Hash = Hasher, typename Eq = std::equal_to<>>
+    class FlatSet : public Table<Key, Key, SetKeyOf<Key>, Hash, Eq> {
+        using Base = Table<Key, Key, SetKeyOf<Key>, Hash, Eq>;
+
+    public:
+        using key_type = Key;
+        using value_type = Key;
+        using typename Base::iterator;
+        using typename Base::const_iterator;
+
+        using Base::Base;
+
+        template <typename K> requires Base::template lookup_key<K>
+        std::pair<iterator, bool> insert(K&& key) {
+            auto [i, inserted] = this->find_or_insert(key, [&](Key* p) {
+                std::construct_at(p, std::forward<K>(key));
+            });
+            return { this->iterator_at(i), inserted };
+        }
+
+        template <typename K> requires Base::template lookup_key<K>
+        size_t count(const K& key) const noexcept { return this->count_of(key); }
+    };
+
+} // namespace jsHashMap
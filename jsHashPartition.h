@@ -0,0 +1,200 @@
+#pragma once
+// file jsHashPartition.h
+// MIT License. Copyright (c) 2025 Jim Staley. See LICENSE for details.
+
+/*
+file jsHashPartition.h
+
+Radix partitioning by jsHash, the first step of a partitioned hash join:
+(key, payload) pairs are scattered into 2^bits partitions by the top
+bits of hash_u64(key, seed), so each partition's hash table fits in cache.
+
+    std::vector<jsHashPartition::Tuple> out(n);
+    std::vector<size_t> bounds((size_t(1) << bits) + 1);
+    ThreadPool pool;
+    jsHashPartition::partition(keys, payloads, n, bits, seed, out.data(), bounds.data(), pool);
+    // partition p is out[bounds[p] .. bounds[p + 1])
+
+The partition of a key is partition_of(key, bits, seed), the top bits of
+the hash, so a table built inside a partition can still index with the
+low bits. Within a partition the tuples keep their input order; the
+result does not depend on the number of threads.
+
+Passes
+    1. The input is cut into one contiguous chunk per thread. Each chunk
+       hashes its keys (jsHash::hash_column_u64, 256 at a time) and counts
+       its tuples per partition.
+    2. Prefix sum over (partition, chunk): where each chunk writes in
+       each partition.
+    3. Each chunk hashes its keys again and scatters the tuples.
+
+Software write-combining (pass 3)
+    Writing every tuple straight to its partition touches 2^bits output
+    streams at once, more than the TLB and the fill buffers can follow.
+    Instead each thread stages tuples in one 64-byte line per partition
+    (2^bits lines, meant to stay in L1/L2) and writes a line out when it
+    is full, with non-temporal stores on x86-64. The first line of each
+    (chunk, partition) run is offset so that later lines are aligned to
+    64 bytes in out; partial lines at either end use ordinary stores.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "jsHash.h"
+#include "ThreadPool.h"
+
+namespace jsHashPartition {
+
+    struct alignas(16) Tuple {
+        uint64_t key;
+        uint64_t payload;
+    };
+
+    inline constexpr unsigned MaxBits = 14;         // 16384 staging lines = 1 MiB per thread
+    inline constexpr size_t   HashRun = 256;        // keys hashed per hash_column_u64 call
+    inline constexpr size_t   MinChunk = 1 << 16;   // fewer tuples per thread are not worth a thread
+    inline constexpr size_t   LineTuples = 64 / sizeof(Tuple);
+
+    // bits in 1..MaxBits.
+    inline size_t partition_of(uint64_t key, unsigned bits, uint64_t seed = 42) noexcept {
+        return size_t(jsHash::hash_u64(key, seed) >> (64 - bits));
+    }
+
+    namespace detail {
+
+        // fn(partition, i) for every key of [first, last), in order.
+        template <typename F>
+        inline void for_each_partition(const uint64_t* keys, size_t first, size_t last,
+            unsigned bits, uint64_t seed, F&& fn)
+        {
+            uint64_t h[HashRun];
+            for (size_t base = first; base < last; base += HashRun) {
+                const size_t m = std::min(HashRun, last - base);
+                jsHash::hash_column_u64(keys + base, h, m, seed);
+                for (size_t i = 0; i < m; ++i)
+                    fn(size_t(h[i] >> (64 - bits)), base + i);
+            }
+        }
+
+        inline void store_line(Tuple* dst, const Tuple* src) noexcept {
+#if JSHASH_HAVE_MOVNTI
+            const __m128i* s = reinterpret_cast<const __m128i*>(src);
+            __m128i* d = reinterpret_cast<__m128i*>(dst);
+            _mm_stream_si128(d + 0, _mm_load_si128(s + 0));
+            _mm_stream_si128(d + 1, _mm_load_si128(s + 1));
+            _mm_stream_si128(d + 2, _mm_load_si128(s + 2));
+            _mm_stream_si128(d + 3, _mm_load_si128(s + 3));
+#else
+            std::memcpy(dst, src, 64);
+#endif
+        }
+
+        // Pass 3 for one chunk. start[p]: out index of the chunk's first tuple of p.
+        inline void scatter(const uint64_t* keys, const uint64_t* payloads, size_t first, size_t last,
+            unsigned bits, uint64_t seed, Tuple* out, const size_t* start)
+        {
+            struct alignas(64) Line { Tuple t[LineTuples]; };
+            const size_t parts = size_t(1) << bits;
+            std::unique_ptr<Line[]> lines(new Line[parts]);
+            std::unique_ptr<size_t[]> pos(new size_t[parts]);
+            std::unique_ptr<uint8_t[]> fill(new uint8_t[parts]);
+
+            // Each staged tuple sits in the slot it will have in out's 64-byte grid.
+            for (size_t p = 0; p < parts; ++p) {
+                pos[p] = start[p];
+                fill[p] = uint8_t((reinterpret_cast<uintptr_t>(out + start[p]) % 64) / sizeof(Tuple));
+            }
+
+            // Writes the staged tuples of line p that belong to this run: the last
+            // min(fill, pos - start) of them (the line may begin before the run).
+            const auto flush_partial = [&](size_t p) {
+                const size_t k = std::min<size_t>(fill[p], pos[p] - start[p]);
+                std::memcpy(out + pos[p] - k, &lines[p].t[fill[p] - k], k * sizeof(Tuple));
+            };
+
+            for_each_partition(keys, first, last, bits, seed, [&](size_t p, size_t i) {
+                lines[p].t[fill[p]] = Tuple{ keys[i], payloads[i] };
+                ++pos[p];
+                if (++fill[p] == LineTuples) {
+                    if (pos[p] - start[p] >= LineTuples)
+                        store_line(out + pos[p] - LineTuples, lines[p].t);
+                    else
+                        flush_partial(p);
+                    fill[p] = 0;
+                }
+            });
+
+            for (size_t p = 0; p < parts; ++p)
+                if (fill[p] > 0)
+                    flush_partial(p);
+#if JSHASH_HAVE_MOVNTI
+            _mm_sfence();
+#endif
+        }
+
+        // run(chunks, fn) calls fn(c) for every chunk c.
+        template <typename Run>
+        inline bool partition(const uint64_t* keys, const uint64_t* payloads, size_t n, unsigned bits,
+            uint64_t seed, Tuple* out, size_t* bounds, size_t chunks, Run&& run)
+        {
+            if (bits < 1 || bits > MaxBits)
+                return false;
+            const size_t parts = size_t(1) << bits;
+            const auto first = [&](size_t c) { return n / chunks * c + std::min(c, n % chunks); };
+
+            // 1. histograms, one row per chunk
+            std::vector<size_t> runs(chunks * parts, 0);
+            run(chunks, [&](size_t c) {
+                size_t* count = &runs[c * parts];
+                for_each_partition(keys, first(c), first(c + 1), bits, seed,
+                    [&](size_t p, size_t) { ++count[p]; });
+            });
+
+            // 2. prefix sum, partition-major: runs[c][p] becomes where chunk c starts in p
+            size_t sum = 0;
+            for (size_t p = 0; p < parts; ++p) {
+                bounds[p] = sum;
+                for (size_t c = 0; c < chunks; ++c) {
+                    const size_t count = runs[c * parts + p];
+                    runs[c * parts + p] = sum;
+                    sum += count;
+                }
+            }
+            bounds[parts] = sum;
+
+            // 3. scatter
+            run(chunks, [&](size_t c) {
+                scatter(keys, payloads, first(c), first(c + 1), bits, seed, out, &runs[c * parts]);
+            });
+            return true;
+        }
+    }
+
+    /*----------------------------------------------------------------*
+     *  partition – scatter (keys[i], payloads[i]) by partition_of(keys[i])
+     *
+     *  out: n tuples; bounds: 2^bits + 1 entries. Returns false (and
+     *  writes nothing) unless bits is in 1..MaxBits. out must not
+     *  overlap the inputs.
+     *----------------------------------------------------------------*/
+    inline bool partition(const uint64_t* keys, const uint64_t* payloads, size_t n, unsigned bits,
+        uint64_t seed, Tuple* out, size_t* bounds, ThreadPool& pool)
+    {
+        const size_t chunks = std::clamp<size_t>(n / MinChunk, 1, pool.size() + 1);
+        return detail::partition(keys, payloads, n, bits, seed, out, bounds, chunks,
+            [&](size_t count, auto&& fn) { pool.parallel_for(count, fn); });
+    }
+
+    // Single-threaded.
+    inline bool partition(const uint64_t* keys, const uint64_t* payloads, size_t n, unsigned bits,
+        uint64_t seed, Tuple* out, size_t* bounds)
+    {
+        return detail::partition(keys, payloads, n, bits, seed, out, bounds, 1,
+            [](size_t, auto&& fn) { fn(size_t(0)); });
+    }
+}
@@ -0,0 +1,131 @@
+#pragma once
+// file jsHashRows.h
+// MIT License. Copyright (c) 2025 Jim Staley. See LICENSE for details.
+
+/*
+file jsHashRows.h
+
+Composite-key hashing over columns: one hash per row of N columns,
+without building the rows.
+
+    jsHashRows::Column cols[] = {
+        jsHashRows::Column::of(customer_id),             // uint64_t[nrows]
+        jsHashRows::Column::of(region),                  // uint32_t[nrows]
+        jsHashRows::Column::strings(name_offsets, name_chars),
+    };
+    jsHashRows::hash_rows(cols, 3, nrows, hashes, seed);
+
+What is computed
+    field(j, r) = Hash64(bytes of row r in column j, seed)
+    row(r)      = hash_combine(... hash_combine(seed, field(0, r)) ..., field(N-1, r))
+    (jsHash::hash_combine). Each field is hashed with its own length, so
+    ("ab", "c") and ("a", "bc") give different rows. Column order matters.
+    hash_row() computes the same value for a single row.
+
+Column at a time
+    Rows are taken RowBatch at a time. For each column the batch's field
+    hashes go to an L1 buffer, then are combined into the row hashes.
+    Fields are hashed by the jsHash column functions: hash_column_u64 /
+    _u32 for 8- and 4-byte columns (AVX-512 when available),
+    hash_column_strings for strings; other widths one-shot per field.
+    Nothing is serialized and no jsHash object is created per row.
+
+Columns
+    • fixed width: nrows values of width bytes, back to back. Values are
+      hashed as raw bytes, so padding must be zeroed and floating point
+      columns are not canonicalized (use jsHash::hash_column_double and
+      hash_combine for that).
+    • strings (Arrow layout): value r is chars[offsets[r] .. offsets[r + 1]),
+      offsets has nrows + 1 entries.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "jsHash.h"
+
+namespace jsHashRows {
+
+    inline constexpr size_t RowBatch = 256;
+
+    struct Column {
+        const uint8_t*  data = nullptr;     // fixed: the values; strings: the characters
+        size_t          width = 0;          // fixed: bytes per value
+        const uint32_t* offsets = nullptr;  // strings only: nrows + 1 offsets into data
+
+        static Column fixed(const void* values, size_t width) noexcept {
+            return { static_cast<const uint8_t*>(values), width, nullptr };
+        }
+
+        template <typename T>
+        static Column of(const T* values) noexcept {
+            static_assert(std::has_unique_object_representations_v<T>,
+                "T must have no padding and compare by bytes (hash floats with hash_column_double)");
+            return fixed(values, sizeof(T));
+        }
+
+        static Column strings(const uint32_t* offsets, const void* chars) noexcept {
+            return { static_cast<const uint8_t*>(chars), 0, offsets };
+        }
+
+        bool is_strings() const noexcept { return offsets != nullptr; }
+    };
+
+    // Hash of row r's value in column c.
+    inline uint64_t hash_field(const Column& c, size_t r, const jsHashKey& key) noexcept {
+        if (c.is_strings())
+            return jsHash::hash64_oneshot(c.data + c.offsets[r], c.offsets[r + 1] - c.offsets[r], key);
+        return jsHash::hash64_oneshot(c.data + r * c.width, c.width, key);
+    }
+
+    // f[i] = hash_field(c, first + i) for i < m.
+    inline void hash_fields(const Column& c, size_t first, size_t m, uint64_t seed,
+        const jsHashKey& key, uint64_t* f) noexcept
+    {
+        if (c.is_strings()) {
+            jsHash::hash_column_strings(c.offsets + first, c.data, f, m, seed);
+            return;
+        }
+        const uint8_t* p = c.data + first * c.width;
+        const uintptr_t addr = reinterpret_cast<uintptr_t>(p);
+        if (c.width == 8 && addr % alignof(uint64_t) == 0) {
+            jsHash::hash_column_u64(reinterpret_cast<const uint64_t*>(p), f, m, seed);
+            return;
+        }
+        if (c.width == 4 && addr % alignof(uint32_t) == 0) {
+            jsHash::hash_column_u32(reinterpret_cast<const uint32_t*>(p), f, m, seed);
+            return;
+        }
+        for (size_t i = 0; i < m; ++i)
+            f[i] = hash_field(c, first + i, key);
+    }
+
+    // out[r] = row(r) for r < nrows; see the top of this file.
+    inline void hash_rows(const Column* cols, size_t ncols, size_t nrows,
+        uint64_t* out, uint64_t seed = 42) noexcept
+    {
+        const jsHashKey key(seed);
+        uint64_t f[RowBatch];
+        for (size_t base = 0; base < nrows; base += RowBatch) {
+            const size_t m = std::min(RowBatch, nrows - base);
+            uint64_t* h = out + base;
+            std::fill(h, h + m, seed);
+            for (size_t j = 0; j < ncols; ++j) {
+                hash_fields(cols[j], base, m, seed, key, f);
+                for (size_t i = 0; i < m; ++i)
+                    h[i] = jsHash::hash_combine(h[i], f[i]);
+            }
+        }
+    }
+
+    // One row; same value as hash_rows() gives for it.
+    inline uint64_t hash_row(const Column* cols, size_t ncols, size_t row, uint64_t seed = 42) noexcept {
+        const jsHashKey key(seed);
+        uint64_t h = seed;
+        for (size_t j = 0; j < ncols; ++j)
+            h = jsHash::hash_combine(h, hash_field(cols[j], row, key));
+        return h;
+    }
+}
@@ -0,0 +1,462 @@
+#pragma once
+// file jsHashSketch.h
+// MIT License. Copyright (c) 2025 Jim Staley. See LICENSE for details.
+
+/*
+file jsHashSketch.h
+
+Mergeable streaming sketches on jsHash: one hash per item.
+
+    jsHashSketch::HyperLogLog hll(14);              // 2^14 registers, ~0.8 % error
+    hll.add(item, len);                             // Hash64 of the item
+    hll.add_hashes(hashes, n);                      // or precomputed Hash64 values
+    double distinct = hll.estimate();
+
+    jsHashSketch::CountMin cm(4, 1 << 16);          // depth × width counters
+    cm.add(item, len, 3);                           // hash128 of the item
+    uint64_t at_most = cm.estimate(item, len);      // never below the true count
+
+    jsHashSketch::CountSketch cs(5, 1 << 16);       // unbiased, median of rows
+
+Every sketch has a seed; sketches merge only with sketches of the same
+shape and seed (merge() returns false otherwise). Counting with different
+seeds, or mixing items hashed with another seed, gives nonsense.
+
+HyperLogLog
+    • Register index = top p bits of the Hash64, rank = 1 + leading zeros
+      of the remaining 64 - p bits.
+    • Sparse while small: (index, rank) pairs in a sorted list, using at
+      most as many bytes as the dense registers would. New pairs go into a
+      small unsorted buffer that is sorted in when it fills (by add and
+      merge only: const members such as estimate() read the buffer but
+      never change the sketch, so several threads may read one sketch).
+      The sketch turns dense past m/4 pairs. Both forms give the same
+      estimate.
+    • Estimate: Ertl's improved estimator ("New cardinality estimation
+      algorithms for HyperLogLog sketches", 2017) over the register
+      histogram. No bias tables and no switch-over between linear
+      counting and the raw estimate; relative error ≈ 1.04 / sqrt(m).
+    • Merge is a register-wise max (SSE2 pmaxub, 16 registers per step).
+
+Count-Min / Count-Sketch
+    • One hash128 (h0, h1) per item gives all rows: row i uses
+      x_i = h0 + i·(h1 | 1), column = top log2(width) bits of x_i.
+      Count-Sketch takes the next bit of x_i as the ±1 sign.
+    • Count-Min estimate = min over rows (biased up, never under).
+      Count-Sketch estimate = median over rows (unbiased, can go negative).
+    • Merge adds counters.
+
+Merging many sketches in parallel
+    jsHashSketch::merge_parallel(dst, parts, count, pool) splits the
+    registers / counters of dst into slices and merges every part's
+    slice on the pool's threads. The result equals merging serially.
+*/
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "jsHash.h"
+#include "ThreadPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define JSHASH_SKETCH_SSE2 1
+#else
+#   define JSHASH_SKETCH_SSE2 0
+#endif
+
+namespace jsHashSketch {
+
+    /*----------------------------------------------------------------*
+     *  HyperLogLog
+     *----------------------------------------------------------------*/
+    class HyperLogLog {
+    public:
+        static constexpr int MinPrecision = 4;
+        static constexpr int MaxPrecision = 18;
+
+    private:
+        int      p;
+        uint64_t seed;
+        bool     dense = false;
+        std::vector<uint8_t> registers;             // dense: 2^p ranks
+        std::vector<uint32_t> sparse;       // sorted (index << 8 | rank), one per index
+        std::vector<uint32_t> pending;      // unsorted, not yet in sparse
+
+        static constexpr size_t PendingLimit = 256;
+
+    public:
+        explicit HyperLogLog(int precision = 14, uint64_t seed_ = 42)
+            : p(std::clamp(precision, MinPrecision, MaxPrecision)), seed(seed_) {}
+
+        int precision() const noexcept { return p; }
+        size_t register_count() const noexcept { return size_t(1) << p; }
+        bool is_dense() const noexcept { return dense; }
+
+        // Bytes held by the representation (registers or pairs).
+        size_t memory_bytes() const noexcept {
+            return dense ? registers.size()
+                : (sparse.capacity() + pending.capacity()) * sizeof(uint32_t);
+        }
+
+        void add(const void* data, size_t n) { add_hash(Hash64(data, n, seed)); }
+
+        void add_hash(uint64_t h) {
+            const uint32_t index = (uint32_t)(h >> (64 - p));
+            const uint8_t rank = rank_of(h);
+            if (dense) {
+                registers[index] = std::max(registers[index], rank);
+                return;
+            }
+            add_pair(index << 8 | rank);
+        }
+
+        // Hash64 values of the items, computed with this sketch's seed.
+        void add_hashes(const uint64_t* hashes, size_t count) {
+            size_t i = 0;
+            for (; i < count && !dense; ++i)
+                add_hash(hashes[i]);
+
+            uint8_t* r = registers.data();
+            for (; i < count; ++i) {
+                const uint32_t index = (uint32_t)(hashes[i] >> (64 - p));
+                r[index] = std::max(r[index], rank_of(hashes[i]));
+            }
+        }
+
+        double estimate() const {
+            // Histogram of register values 0..q+1, q = 64 - p.
+            const int q = 64 - p;
+            std::array<uint64_t, 66> c{};
+            if (dense) {
+                // Four histograms break the store-to-load chain on repeated values.
+                std::array<std::array<uint32_t, 66>, 4> part{};
+                const size_t m = registers.size();
+                size_t i = 0;
+                for (; i + 4 <= m; i += 4)
+                    for (int j = 0; j < 4; ++j)
+                        ++part[j][registers[i + j]];
+                for (; i < m; ++i)
+                    ++part[0][registers[i]];
+                for (int k = 0; k <= q + 1; ++k)
+                    c[k] = (uint64_t)part[0][k] + part[1][k] + part[2][k] + part[3][k];
+            }
+            else {
+                // Pending pairs are merged into a copy; the sketch is left alone.
+                std::vector<uint32_t> merged;
+                const std::vector<uint32_t>* pairs = &sparse;
+                if (!pending.empty()) {
+                    merged = sparse;
+                    std::vector<uint32_t> extra = pending;
+                    merge_pairs(merged, extra);
+                    pairs = &merged;
+                }
+                c[0] = register_count() - pairs->size();
+                for (uint32_t e : *pairs)
+                    ++c[e & 0xff];
+            }
+
+            const double m = (double)register_count();
+            double z = m * tau(1.0 - (double)c[q + 1] / m);
+            for (int k = q; k >= 1; --k)
+                z = 0.5 * (z + (double)c[k]);
+            z += m * sigma((double)c[0] / m);
+            return 0.5 / std::log(2.0) * m * m / z;
+        }
+
+        bool merge(const HyperLogLog& other) {
+            if (!compatible(other))
+                return false;
+            if (&other == this)
+                return true;
+            if (!other.dense) {
+                for (uint32_t e : other.sparse)
+                    add_pair(e);
+                for (uint32_t e : other.pending)
+                    add_pair(e);
+                return true;
+            }
+            to_dense();
+            merge_range(other, 0, registers.size());
+            return true;
+        }
+
+        void clear() {
+            dense = false;
+            registers.clear();
+            registers.shrink_to_fit();
+            sparse.clear();
+            pending.clear();
+        }
+
+        /*------------------------------------------------------------*
+         *  For merge_parallel(): slice [begin, end) of the registers
+         *------------------------------------------------------------*/
+        size_t cells() const noexcept { return register_count(); }
+
+        bool compatible(const HyperLogLog& other) const noexcept {
+            return other.p == p && other.seed == seed;
+        }
+
+        // Makes every part safe to read from several threads at once.
+        void prepare_merge_target() { to_dense(); }
+        void prepare_merge_source() const noexcept {}
+
+        void merge_range(const HyperLogLog& other, size_t begin, size_t end) noexcept {
+            uint8_t* r = registers.data();
+            if (!other.dense) {
+                auto it = std::lower_bound(other.sparse.begin(), other.sparse.end(), uint32_t(begin << 8));
+                for (; it != other.sparse.end() && (*it >> 8) < end; ++it)
+                    r[*it >> 8] = std::max(r[*it >> 8], uint8_t(*it & 0xff));
+                for (uint32_t e : other.pending)            // at most PendingLimit, unsorted
+                    if ((e >> 8) >= begin && (e >> 8) < end)
+                        r[e >> 8] = std::max(r[e >> 8], uint8_t(e & 0xff));
+                return;
+            }
+            const uint8_t* o = other.registers.data();
+            size_t i = begin;
+#if JSHASH_SKETCH_SSE2
+            for (; i + 16 <= end; i += 16) {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r + i));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(o + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(r + i), _mm_max_epu8(a, b));
+            }
+#endif
+            for (; i < end; ++i)
+                r[i] = std::max(r[i], o[i]);
+        }
+
+    private:
+        uint8_t rank_of(uint64_t h) const noexcept {
+            // Leading zeros of the low 64 - p bits, plus one; at most 65 - p.
+            const uint64_t w = h << p;
+            return (uint8_t)(std::min(std::countl_zero(w), 64 - p) + 1);
+        }
+
+        void add_pair(uint32_t e) {
+            if (dense) {
+                uint8_t& r = registers[e >> 8];
+                r = std::max(r, uint8_t(e & 0xff));
+                return;
+            }
+            pending.push_back(e);
+            if (pending.size() >= PendingLimit) {
+                flush();
+                if (sparse.size() > register_count() / 4)
+                    to_dense();
+            }
+        }
+
+        // Sorts pending pairs into sparse, keeping the highest rank per index.
+        void flush() {
+            merge_pairs(sparse, pending);
+        }
+
+        // Sorts extra into sorted (then empties extra); one pair per index remains.
+        static void merge_pairs(std::vector<uint32_t>& sorted, std::vector<uint32_t>& extra) {
+            if (extra.empty())
+                return;
+            std::sort(extra.begin(), extra.end());
+            const size_t old = sorted.size();
+            sorted.insert(sorted.end(), extra.begin(), extra.end());
+            extra.clear();
+            std::inplace_merge(sorted.begin(), sorted.begin() + old, sorted.end());
+
+            // Same index → adjacent, ascending rank: keep the last of each run.
+            size_t out = 0;
+            for (size_t i = 0; i < sorted.size(); ++i) {
+                if (i + 1 < sorted.size() && (sorted[i + 1] >> 8) == (sorted[i] >> 8))
+                    continue;
+                sorted[out++] = sorted[i];
+            }
+            sorted.resize(out);
+        }
+
+        void to_dense() {
+            if (dense)
+                return;
+            flush();
+            registers.assign(register_count(), 0);
+            for (uint32_t e : sparse)
+                registers[e >> 8] = uint8_t(e & 0xff);
+            sparse.clear();
+            sparse.shrink_to_fit();
+            pending.shrink_to_fit();
+            dense = true;
+        }
+
+        // Ertl 2017, algorithms 6 and 7.
+        static double sigma(double x) noexcept {
+            if (x == 1.0)
+                return std::numeric_limits<double>::infinity();
+            double y = 1.0, z = x, z_old;
+            do {
+                x *= x;
+                z_old = z;
+                z += x * y;
+                y += y;
+            } while (z != z_old);
+            return z;
+        }
+
+        static double tau(double x) noexcept {
+            if (x == 0.0 || x == 1.0)
+                return 0.0;
+            double y = 1.0, z = 1.0 - x, z_old;
+            do {
+                x = std::sqrt(x);
+                z_old = z;
+                y *= 0.5;
+                z -= (1.0 - x) * (1.0 - x) * y;
+            } while (z != z_old);
+            return z / 3.0;
+        }
+    };
+
+    /*----------------------------------------------------------------*
+     *  Count-Min and Count-Sketch
+     *
+     *  depth rows of width counters (width rounded up to a power of two,
+     *  depth clamped to 1..MaxDepth). Items are hashed with hash128_oneshot(item, seed); add_hashes()
+     *  takes those hash128 values precomputed.
+     *----------------------------------------------------------------*/
+    template <typename Counter, bool Signed>
+    class FrequencySketch {
+    public:
+        using Hash = std::array<uint64_t, 2>;
+        static constexpr size_t MaxDepth = 64;      // Count-Sketch medians sort on the stack
+
+    private:
+        size_t   depth;
+        size_t   width;
+        int      shift;                 // 64 - log2(width)
+        uint64_t seed;
+        std::vector<Counter> counters;  // row-major, depth × width
+
+    public:
+        FrequencySketch(size_t depth_, size_t width_, uint64_t seed_ = 42)
+            : depth(std::clamp<size_t>(depth_, 1, MaxDepth)),
+              width(std::bit_ceil(std::max<size_t>(2, width_))),
+              shift(64 - std::countr_zero(width)),
+              seed(seed_),
+              counters(depth * width, 0) {}
+
+        size_t rows() const noexcept { return depth; }
+        size_t columns() const noexcept { return width; }
+
+        Hash hash(const void* data, size_t n) const noexcept {
+            return jsHash::hash128_oneshot(data, n, seed);
+        }
+
+        void add(const void* data, size_t n, Counter count = 1) noexcept { add_hash(hash(data, n), count); }
+        Counter estimate(const void* data, size_t n) const noexcept { return estimate_hash(hash(data, n)); }
+
+        void add_hash(const Hash& h, Counter count = 1) noexcept {
+            const uint64_t step = h[1] | 1;
+            uint64_t x = h[0];
+            for (size_t row = 0; row < depth; ++row, x += step) {
+                Counter& c = counters[row * width + (size_t)(x >> shift)];
+                if constexpr (Signed)
+                    c += sign(x) ? -count : count;
+                else
+                    c += count;
+            }
+        }
+
+        // counts == nullptr adds 1 per hash.
+        void add_hashes(const Hash* hashes, size_t n, const Counter* counts = nullptr) noexcept {
+            for (size_t i = 0; i < n; ++i)
+                add_hash(hashes[i], counts ? counts[i] : Counter(1));
+        }
+
+        Counter estimate_hash(const Hash& h) const noexcept {
+            const uint64_t step = h[1] | 1;
+            uint64_t x = h[0];
+            if constexpr (!Signed) {
+                Counter best = std::numeric_limits<Counter>::max();
+                for (size_t row = 0; row < depth; ++row, x += step)
+                    best = std::min(best, counters[row * width + (size_t)(x >> shift)]);
+                return best;
+            }
+            else {
+                Counter row_values[MaxDepth];
+                for (size_t row = 0; row < depth; ++row, x += step) {
+                    const Counter c = counters[row * width + (size_t)(x >> shift)];
+                    row_values[row] = sign(x) ? -c : c;
+                }
+                std::nth_element(row_values, row_values + depth / 2, row_values + depth);
+                return row_values[depth / 2];
+            }
+        }
+
+        bool merge(const FrequencySketch& other) noexcept {
+            if (!compatible(other))
+                return false;
+            merge_range(other, 0, counters.size());
+            return true;
+        }
+
+        void clear() noexcept { std::fill(counters.begin(), counters.end(), Counter(0)); }
+
+        // For merge_parallel(): slice [begin, end) of the counters.
+        size_t cells() const noexcept { return counters.size(); }
+
+        bool compatible(const FrequencySketch& other) const noexcept {
+            return other.depth == depth && other.width == width && other.seed == seed;
+        }
+
+        void prepare_merge_target() noexcept {}
+        void prepare_merge_source() const noexcept {}
+
+        void merge_range(const FrequencySketch& other, size_t begin, size_t end) noexcept {
+            Counter* a = counters.data();
+            const Counter* b = other.counters.data();
+            for (size_t i = begin; i < end; ++i)
+                a[i] += b[i];
+        }
+
+    private:
+        // The bit right below the column bits.
+        bool sign(uint64_t x) const noexcept {
+            return (x >> (shift - 1)) & 1;
+        }
+    };
+
+    using CountMin = FrequencySketch<uint64_t, false>;
+    using CountSketch = FrequencySketch<int64_t, true>;
+
+    /*----------------------------------------------------------------*
+     *  merge_parallel – dst |= parts[0..count), sliced over the pool
+     *
+     *  Returns false (and merges nothing) if any part has a different
+     *  shape or seed.
+     *----------------------------------------------------------------*/
+    template <typename Sketch>
+    bool merge_parallel(Sketch& dst, const Sketch* parts, size_t count, ThreadPool& pool) {
+        for (size_t i = 0; i < count; ++i)
+            if (!dst.compatible(parts[i]))
+                return false;
+
+        dst.prepare_merge_target();
+        for (size_t i = 0; i < count; ++i)
+            parts[i].prepare_merge_source();
+
+        // Slices of at least 64 KiB cells, a few per thread.
+        const size_t cells = dst.cells();
+        const size_t slices = std::clamp<size_t>(cells / 65536, 1, 4 * (size_t)pool.size() + 4);
+        pool.parallel_for(slices, [&](size_t s) {
+            const size_t begin = cells * s / slices;
+            const size_t end = cells * (s + 1) / slices;
+            for (size_t i = 0; i < count; ++i)
+                dst.merge_range(parts[i], begin, end);
+        });
+        return true;
+    }
+
+} // namespace jsHashSketch
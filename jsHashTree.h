@@ -0,0 +1,138 @@
+#pragma once
+// file jsHashTree.h
+// MIT License. Copyright (c) 2025 Jim Staley. See LICENSE for details.
+
+/*
+file jsHashTree.h
+
+Tree mode for jsHash – hashes one large input on many cores.
+
+Sequential jsHash cannot be split: every block depends on the lane state
+left by the previous one. Tree mode cuts the input into fixed chunks,
+hashes each chunk independently (the leaves), and combines the leaves
+pairwise into a Merkle-style root. The leaves can be computed on any
+number of threads; the result does not depend on the thread count.
+
+Tree mode is a different function from sequential jsHash / Hash64 and
+gives different values for the same input. Its layout is fixed by
+jsHashTree::Version; any change to the layout gets a new version.
+
+Layout, version 1
+    • ChunkSize = 1 MiB. An n-byte input has max(1, ceil(n / ChunkSize))
+      leaves; the last chunk may be short, an empty input is one empty leaf.
+    • leaf_i  = jsHash(seed).insert(chunk_i).hash256()
+    • parent  = jsHash(seed ^ NodeDomain).insert(left || right).hash256()
+      Each level pairs neighbours left to right; an odd node at the end of
+      a level moves up unchanged. (This is the same shape as splitting the
+      leaves at the largest power of two, recursively.)
+    • root    = jsHash(seed ^ RootDomain).insert(top || n || Version || ChunkSize).hash256()
+      with n, Version and ChunkSize as little-endian 64-bit words.
+
+    Every combining step is plain jsHash (the mix() primitive); the keys
+    separate leaves, inner nodes and the root.
+
+Usage
+    ThreadPool pool;
+    auto h = jsHashTree::hash256(data, n, seed, pool);     // parallel
+    auto g = jsHashTree::hash256(data, n, seed);           // one thread, same value
+    uint64_t h64 = jsHashTree::hash64(data, n, seed, pool);
+*/
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "jsHash.h"
+#include "ThreadPool.h"
+
+namespace jsHashTree {
+
+    using Node = std::array<uint64_t, 4>;
+
+    static constexpr uint64_t Version = 1;
+    static constexpr size_t   ChunkSize = size_t(1) << 20;
+
+    static constexpr uint64_t NodeDomain = 0x65646f6e2d68736aULL;   // "jsh-node" (little-endian ASCII)
+    static constexpr uint64_t RootDomain = 0x746f6f722d68736aULL;   // "jsh-root"
+
+    inline size_t leaf_count(size_t n) noexcept {
+        return n == 0 ? 1 : (n + ChunkSize - 1) / ChunkSize;
+    }
+
+    inline Node leaf(const uint8_t* data, size_t n, size_t index, uint64_t seed) noexcept {
+        const size_t begin = index * ChunkSize;
+        const size_t len = std::min(ChunkSize, n - begin);
+        jsHash h(seed);
+        h.insert(data + begin, len);
+        return std::move(h).hash256();
+    }
+
+    inline Node parent(const Node& left, const Node& right, uint64_t seed) noexcept {
+        uint64_t both[8];
+        std::memcpy(both, left.data(), 32);
+        std::memcpy(both + 4, right.data(), 32);
+        jsHash h(seed ^ NodeDomain);
+        h.insert(reinterpret_cast<const uint8_t*>(both), sizeof(both));
+        return std::move(h).hash256();
+    }
+
+    // Reduces the leaves to the root in place (level by level).
+    inline Node root(std::vector<Node>& nodes, size_t n, uint64_t seed) noexcept {
+        size_t count = nodes.size();
+        while (count > 1) {
+            size_t out = 0;
+            for (size_t i = 0; i + 1 < count; i += 2)
+                nodes[out++] = parent(nodes[i], nodes[i + 1], seed);
+            if (count & 1)
+                nodes[out++] = nodes[count - 1];
+            count = out;
+        }
+
+        uint64_t block[7];
+        std::memcpy(block, nodes[0].data(), 32);
+        block[4] = n;
+        block[5] = Version;
+        block[6] = ChunkSize;
+        jsHash h(seed ^ RootDomain);
+        h.insert(reinterpret_cast<const uint8_t*>(block), sizeof(block));
+        return std::move(h).hash256();
+    }
+
+    // Single-threaded reference.
+    inline Node hash256(const void* data, size_t n, uint64_t seed = 42) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        std::vector<Node> nodes(leaf_count(n));
+        for (size_t i = 0; i < nodes.size(); ++i)
+            nodes[i] = leaf(p, n, i, seed);
+        return root(nodes, n, seed);
+    }
+
+    // Leaves spread over the pool; same value as the single-threaded version.
+    inline Node hash256(const void* data, size_t n, uint64_t seed, ThreadPool& pool) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        std::vector<Node> nodes(leaf_count(n));
+        pool.parallel_for(nodes.size(), [&](size_t i) {
+            nodes[i] = leaf(p, n, i, seed);
+        });
+        return root(nodes, n, seed);
+    }
+
+    inline std::array<uint64_t, 2> hash128(const void* data, size_t n, uint64_t seed, ThreadPool& pool) {
+        Node h = hash256(data, n, seed, pool);
+        return { h[0] ^ h[1], h[2] ^ h[3] };
+    }
+
+    inline uint64_t hash64(const void* data, size_t n, uint64_t seed, ThreadPool& pool) {
+        Node h = hash256(data, n, seed, pool);
+        return h[0] ^ h[1] ^ h[2] ^ h[3];
+    }
+
+    inline uint64_t hash64(const void* data, size_t n, uint64_t seed = 42) {
+        Node h = hash256(data, n, seed);
+        return h[0] ^ h[1] ^ h[2] ^ h[3];
+    }
+
+} // namespace jsHashTree
@@ -0,0 +1,187 @@
+// file jshashsum.cpp
+// MIT License. Copyright (c) 2025 Jim Staley. See LICENSE for details.
+//
+// jshashsum – print or check jsHash digests of files, sha256sum style.
+//
+//     jshashsum [-s SEED] [-b 64|128|256] [-j THREADS] FILE...
+//     jshashsum [-s SEED] [-j THREADS] -c SUMFILE
+//
+// Output lines are "<hex digest>  <path>". Files are hashed in parallel
+// (one file per work item, see ThreadPool.h); results are printed in the
+// order the files were given. With -c, each line of SUMFILE is checked
+// and reported as OK or FAILED; the digest width is taken from the line
+// and its hex digits may be upper or lower case.
+// Check lines may use either sha256sum separator, "  " (text mode) or
+// " *" (binary mode); both mean the same here. Unknown options are
+// errors, as are option values that are not whole numbers (SEED may be
+// decimal or 0x hex); "--" ends the options, so files named "-x" can be given.
+// Exit status is 0 when every file was read (and, with -c, matched).
+//
+// Build: g++ -O2 -std=c++20 -pthread jshashsum.cpp -o jshashsum
+
+#include "jsHashFile.h"
+#include "ThreadPool.h"
+
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+    struct Job {
+        std::string path;
+        std::string expected;       // check mode only
+        bool ok = false;
+        int error = 0;              // errno when !ok
+        std::array<uint64_t, 4> hash{};
+    };
+
+    // Digest text: 64, 128 or 256 bits, most significant word first.
+    std::string to_hex(const std::array<uint64_t, 4>& h, int bits) {
+        uint64_t words[4];
+        int n;
+        if (bits == 64) { words[0] = h[0] ^ h[1] ^ h[2] ^ h[3]; n = 1; }
+        else if (bits == 128) { words[0] = h[0] ^ h[1]; words[1] = h[2] ^ h[3]; n = 2; }
+        else { for (int i = 0; i < 4; ++i) words[i] = h[i]; n = 4; }
+
+        std::string s;
+        char tmp[17];
+        for (int i = 0; i < n; ++i) {
+            std::snprintf(tmp, sizeof(tmp), "%016llx", (unsigned long long)words[i]);
+            s += tmp;
+        }
+        return s;
+    }
+
+    // The whole of s as a number: decimal, or hex after "0x". false for a
+    // sign, trailing junk, an empty string or overflow.
+    template <typename T>
+    bool parse_number(std::string_view s, T& value) {
+        int base = 10;
+        if (s.size() > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+            s.remove_prefix(2);
+            base = 16;
+        }
+        const char* end = s.data() + s.size();
+        const auto [ptr, ec] = std::from_chars(s.data(), end, value, base);
+        return !s.empty() && ec == std::errc() && ptr == end;
+    }
+
+    int usage() {
+        std::cerr <<
+            "usage: jshashsum [-s SEED] [-b 64|128|256] [-j THREADS] [--] FILE...\n"
+            "       jshashsum [-s SEED] [-j THREADS] -c SUMFILE\n";
+        return 2;
+    }
+
+    // "<digest>  <path>" or "<digest> *<path>"; false for anything else.
+    bool parse_check_line(const std::string& line, Job& job) {
+        const size_t sep = line.find(' ');
+        if (sep == 0 || sep == std::string::npos || sep + 2 > line.size())
+            return false;
+        if (line[sep + 1] != ' ' && line[sep + 1] != '*')
+            return false;
+        job.expected = line.substr(0, sep);
+        for (char& c : job.expected)        // to_hex() prints lower case
+            c = (char)std::tolower((unsigned char)c);
+        job.path = line.substr(sep + 2);
+        return !job.path.empty();
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint64_t seed = 42;
+    int bits = 256;
+    unsigned threads = 0;
+    std::string check_file;
+    std::vector<Job> jobs;
+
+    bool options = true;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        bool valid = true;
+        if (!options || arg == "-" || arg[0] != '-') jobs.push_back({ arg, {} });
+        else if (arg == "--")               options = false;
+        else if (arg == "-s" && has_value)  valid = parse_number(argv[++i], seed);
+        else if (arg == "-b" && has_value)  valid = parse_number(argv[++i], bits);
+        else if (arg == "-j" && has_value)  valid = parse_number(argv[++i], threads);
+        else if (arg == "-c" && has_value)  check_file = argv[++i];
+        else {
+            if (arg != "-h" && arg != "--help")
+                std::cerr << "jshashsum: unknown option or missing value: " << arg << "\n";
+            return usage();
+        }
+        if (!valid) {
+            std::cerr << "jshashsum: invalid value for " << arg << ": " << argv[i] << "\n";
+            return usage();
+        }
+    }
+    if (bits != 64 && bits != 128 && bits != 256)
+        return usage();
+
+    const bool checking = !check_file.empty();
+    if (checking) {
+        if (!jobs.empty())
+            return usage();
+        std::ifstream in(check_file);
+        if (!in) {
+            std::cerr << "jshashsum: " << check_file << ": " << std::strerror(errno) << "\n";
+            return 1;
+        }
+        std::string line;
+        size_t bad = 0;
+        while (std::getline(in, line)) {
+            Job job;
+            if (parse_check_line(line, job))
+                jobs.push_back(std::move(job));
+            else if (!line.empty())
+                ++bad;
+        }
+        if (bad)
+            std::cerr << "jshashsum: " << check_file << ": " << bad << " line(s) improperly formatted\n";
+    }
+    if (jobs.empty())
+        return usage();
+
+    ThreadPool pool(threads);
+    pool.parallel_for(jobs.size(), [&](size_t i) {
+        Job& job = jobs[i];
+        jsHash h(seed);
+        job.ok = jsHashFile::hash_file(h, job.path);
+        job.error = job.ok ? 0 : errno;
+        if (job.ok)
+            job.hash = h.hash256();
+    });
+
+    int status = 0;
+    for (const Job& job : jobs) {
+        if (!job.ok) {
+            std::cerr << "jshashsum: " << job.path << ": " << std::strerror(job.error) << "\n";
+            if (checking)
+                std::cout << job.path << ": FAILED open or read\n";
+            status = 1;
+            continue;
+        }
+        if (checking) {
+            const int width = (int)job.expected.size() * 4;
+            const bool match = (width == 64 || width == 128 || width == 256)
+                && to_hex(job.hash, width) == job.expected;
+            std::cout << job.path << ": " << (match ? "OK" : "FAILED") << "\n";
+            if (!match)
+                status = 1;
+        }
+        else {
+            std::cout << to_hex(job.hash, bits) << "  " << job.path << "\n";
+        }
+    }
+    return status;
+}